@@ -6,7 +6,7 @@
 
 #include <array>
 #include <cstddef>
-#include <deque>
+#include <vector>
 #include "common/common_types.h"
 
 namespace AudioCore {
@@ -29,8 +29,56 @@ using StereoFrame16 = std::array<std::array<s16, 2>, samples_per_frame>;
 /// The DSP is quadraphonic internally.
 using QuadFrame32 = std::array<std::array<s32, 4>, samples_per_frame>;
 
-/// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::deque<std::array<s16, 2>>;
+/**
+ * A variable length buffer of signed PCM16 stereo samples that is consumed from the front. The
+ * storage is kept when new samples are decoded into it, so a buffer that is reused doesn't
+ * allocate once it's large enough. Room for HISTORY samples is always left before the unread
+ * samples, for the interpolation history.
+ */
+class StereoBuffer16 {
+public:
+    using Sample = std::array<s16, 2>;
+
+    static constexpr std::size_t HISTORY{3};
+
+    StereoBuffer16() : storage(HISTORY) {}
+
+    /// Discards the unread samples and makes room for count new ones
+    Sample* Prepare(std::size_t count) {
+        if (storage.size() < HISTORY + count)
+            storage.resize(HISTORY + count);
+        begin = HISTORY;
+        end = HISTORY + count;
+        return storage.data() + HISTORY;
+    }
+
+    void clear() {
+        begin = end = HISTORY;
+    }
+
+    bool empty() const {
+        return begin == end;
+    }
+
+    std::size_t size() const {
+        return end - begin;
+    }
+
+    /// Returns the unread samples, preceded by HISTORY writable slots
+    Sample* data() {
+        return storage.data() + begin;
+    }
+
+    /// Marks count samples as read
+    void Consume(std::size_t count) {
+        begin += count;
+    }
+
+private:
+    std::vector<Sample> storage;
+    std::size_t begin{HISTORY};
+    std::size_t end{HISTORY};
+};
 
 enum class DspPipe {
     Debug = 0,
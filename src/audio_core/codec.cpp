@@ -13,8 +13,8 @@
 
 namespace AudioCore::Codec {
 
-StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
-                           const std::array<s16, 16>& adpcm_coeff, ADPCMState& state) {
+void DecodeADPCM(const u8* const data, const std::size_t sample_count,
+                 const std::array<s16, 16>& adpcm_coeff, ADPCMState& state, StereoBuffer16& out) {
     // GC-ADPCM with scale factor and variable coefficients.
     // Frames are 8 bytes long containing 14 samples each.
     // Samples are 4 bits (one nibble) long.
@@ -26,7 +26,7 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
 
     const std::size_t ret_size{sample_count % 2 == 0 ? sample_count
                                                      : sample_count + 1}; // Ensure multiple of two.
-    StereoBuffer16 ret{ret_size};
+    auto ret{out.Prepare(ret_size)};
 
     int yn1{state.yn1}, yn2{state.yn2};
 
@@ -74,18 +74,16 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
 
     state.yn1 = yn1;
     state.yn2 = yn2;
-
-    return ret;
 }
 
-StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
-                          const std::size_t sample_count) {
+void DecodePCM8(const unsigned num_channels, const u8* const data, const std::size_t sample_count,
+                StereoBuffer16& out) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
     const auto decode_sample{
         [](u8 sample) { return static_cast<s16>(static_cast<u16>(sample) << 8); }};
 
-    StereoBuffer16 ret{sample_count};
+    auto ret{out.Prepare(sample_count)};
 
     if (num_channels == 1) {
         for (std::size_t i{}; i < sample_count; i++) {
@@ -97,15 +95,13 @@ StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
             ret[i][1] = decode_sample(data[i * 2 + 1]);
         }
     }
-
-    return ret;
 }
 
-StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
-                           const std::size_t sample_count) {
+void DecodePCM16(const unsigned num_channels, const u8* const data, const std::size_t sample_count,
+                 StereoBuffer16& out) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
-    StereoBuffer16 ret{sample_count};
+    auto ret{out.Prepare(sample_count)};
 
     if (num_channels == 1) {
         for (std::size_t i{}; i < sample_count; i++) {
@@ -114,11 +110,7 @@ StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
             ret[i].fill(sample);
         }
     } else {
-        for (std::size_t i{}; i < sample_count; ++i) {
-            std::memcpy(&ret[i], data + i * sizeof(s16) * 2, 2 * sizeof(s16));
-        }
+        std::memcpy(ret, data, sample_count * 2 * sizeof(s16));
     }
-
-    return ret;
 }
 } // namespace AudioCore::Codec
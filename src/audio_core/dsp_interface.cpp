@@ -2,7 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <cmath>
 #include <cstddef>
+#include <mutex>
 #include <unordered_set>
 #include "audio_core/dsp_interface.h"
 #include "audio_core/sink.h"
@@ -29,9 +32,17 @@ DspInterface::DspInterface(Core::System& system) : system{system} {
 DspInterface::~DspInterface() = default;
 
 void DspInterface::UpdateSink() {
-    sink = std::make_unique<Sink>(Settings::values.output_device);
+    // The emulation thread may be pushing samples to the old sink
+    std::lock_guard lock{sink_mutex};
+    // Recreating a file sink would truncate what it has written so far
+    if (sink && sink_immediate && sink_device_id == Settings::values.output_device)
+        return;
+    sink.reset();
+    sink_device_id = Settings::values.output_device;
+    sink = CreateSink(sink_device_id);
     sink->SetCallback(
         [this](s16* buffer, std::size_t num_frames) { OutputCallback(buffer, num_frames); });
+    sink_immediate = sink->IsImmediate();
 }
 
 void DspInterface::EnableStretching(bool enable) {
@@ -45,18 +56,43 @@ void DspInterface::EnableStretching(bool enable) {
 void DspInterface::OutputFrame(StereoFrame16& frame) {
     if (!IsOutputAllowed())
         return;
-    fifo.Push(frame.data(), frame.size());
+    if (PushImmediate(frame[0].data(), frame.size()))
+        return;
+    frames_pushed += fifo.Push(frame.data(), frame.size());
 }
 
 void DspInterface::OutputSample(std::array<s16, 2> sample) {
     if (!IsOutputAllowed())
         return;
-    fifo.Push(&sample, 1);
+    if (PushImmediate(sample.data(), 1))
+        return;
+    frames_pushed += fifo.Push(&sample, 1);
+}
+
+bool DspInterface::PushImmediate(const s16* samples, std::size_t sample_count) {
+    // Immediate sinks get the DSP output as is, so it doesn't depend on host timing
+    if (!sink_immediate)
+        return false;
+    std::lock_guard lock{sink_mutex};
+    // The sink may have been replaced since the flag was read
+    if (!sink->IsImmediate())
+        return false;
+    sink->PushSamples(samples, sample_count);
+    return true;
 }
 
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
+    const std::size_t buffered{fifo.Size()};
+    const std::size_t pushed{frames_pushed.exchange(0)};
+    const bool low_latency{Settings::values.enable_low_latency_audio};
+    // In low latency mode SoundTouch only takes over when the speed is too far off to follow
+    const bool stretch{perform_time_stretching &&
+                       (!low_latency || SpeedDeviates(pushed, num_frames))};
+    if (stretcher_active && !stretch)
+        flushing_time_stretcher = true;
+    stretcher_active = stretch;
     std::size_t frames_written{};
-    if (perform_time_stretching) {
+    if (stretch) {
         const std::vector<s16> in{fifo.Pop()};
         const std::size_t num_in{in.size() / 2};
         frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
@@ -65,8 +101,14 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
         frames_written = time_stretcher.Process(nullptr, 0, buffer, num_frames);
         frames_written += fifo.Pop(buffer, num_frames - frames_written);
         flushing_time_stretcher = false;
-    } else
+    } else if (low_latency)
+        frames_written = OutputLowLatency(buffer, num_frames, buffered);
+    else
         frames_written = fifo.Pop(buffer, num_frames);
+    // Running dry only counts while the emulation is producing audio
+    system.perf_stats.AddAudioBufferSample(
+        std::chrono::microseconds{buffered * 1'000'000 / native_sample_rate},
+        pushed > 0 && frames_written < num_frames);
     if (frames_written > 0)
         std::memcpy(&last_frame[0], buffer + 2 * (frames_written - 1), 2 * sizeof(s16));
     // Hold last emitted frame; this prevents popping.
@@ -83,10 +125,46 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
     }
 }
 
+std::size_t DspInterface::OutputLowLatency(s16* buffer, std::size_t num_frames,
+                                           std::size_t buffered) {
+    // Anything less than a block would run dry on every callback
+    const std::size_t target{std::max<std::size_t>(
+        Settings::values.audio_latency * native_sample_rate / 1000, num_frames)};
+    // Drop a large backlog, e.g. after the emulation ran ahead, instead of keeping the latency
+    if (buffered > target * 4) {
+        const std::size_t excess{buffered - target};
+        if (rate_controller_input.size() < excess * 2)
+            rate_controller_input.resize(excess * 2);
+        buffered -= fifo.Pop(rate_controller_input.data(), excess);
+    }
+    const std::size_t num_in{rate_controller.Update(buffered, target, num_frames)};
+    if (rate_controller_input.size() < num_in * 2)
+        rate_controller_input.resize(num_in * 2);
+    const std::size_t popped{fifo.Pop(rate_controller_input.data(), num_in)};
+    return rate_controller.Process(rate_controller_input.data(), popped, buffer, num_frames);
+}
+
+bool DspInterface::SpeedDeviates(std::size_t pushed, std::size_t num_frames) {
+    // Compare the frames produced and played over about half a second
+    speed_window_pushed += pushed;
+    speed_window_played += num_frames;
+    if (speed_window_played < native_sample_rate / 2)
+        return speed_deviates;
+    const double speed{static_cast<double>(speed_window_pushed) /
+                       static_cast<double>(speed_window_played)};
+    const double deviation{std::abs(speed - 1.0)};
+    // Hysteresis, so the output doesn't keep switching between the two methods
+    if (deviation > 0.05)
+        speed_deviates = true;
+    else if (deviation < 0.02)
+        speed_deviates = false;
+    speed_window_pushed = 0;
+    speed_window_played = 0;
+    return speed_deviates;
+}
+
 bool DspInterface::IsOutputAllowed() {
-    if (!sink)
-        return false;
-    else if (!system.IsSleepModeEnabled())
+    if (!system.IsSleepModeEnabled())
         return true;
     else
         return ids_output_allowed_shell_closed.count(
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 #include "audio_core/audio_types.h"
 #include "audio_core/time_stretch.h"
@@ -109,14 +112,30 @@ protected:
     void OutputSample(std::array<s16, 2> sample);
 
 private:
+    /// Hands the samples to the sink if it's immediate, returns false if it's a real-time sink
+    bool PushImmediate(const s16* samples, std::size_t sample_count);
     void OutputCallback(s16* buffer, std::size_t num_frames);
+    std::size_t OutputLowLatency(s16* buffer, std::size_t num_frames, std::size_t buffered);
+    bool SpeedDeviates(std::size_t frames_pushed, std::size_t num_frames);
     void FlushResidualStretcherAudio();
 
+    std::mutex sink_mutex; ///< Guards the sink, which is replaced on the GUI thread
     std::unique_ptr<Sink> sink;
+    std::string sink_device_id;
+    std::atomic_bool sink_immediate{}; ///< Lets real-time output skip locking the sink
     std::atomic_bool perform_time_stretching{}, flushing_time_stretcher{};
     Common::RingBuffer<s16, 0x2000, 2> fifo;
     std::array<s16, 2> last_frame{};
     TimeStretcher time_stretcher;
+
+    // Low latency output, only touched by the audio thread except for frames_pushed
+    RateController rate_controller;
+    std::vector<s16> rate_controller_input;
+    std::atomic<std::size_t> frames_pushed{};
+    std::size_t speed_window_pushed{};
+    std::size_t speed_window_played{};
+    bool speed_deviates{};
+    bool stretcher_active{};
     Core::System& system;
 };
 
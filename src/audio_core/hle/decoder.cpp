@@ -2,7 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <string>
+#include <fmt/format.h>
 #include "audio_core/hle/decoder.h"
+#include "common/logging/log.h"
+#include "common/thread_pool.h"
 
 namespace AudioCore::HLE {
 
@@ -20,13 +27,10 @@ std::optional<BinaryResponse> NullDecoder::ProcessRequest(const BinaryRequest& r
         std::memcpy(&response, &request, sizeof(response));
         response.unknown1 = 0x0;
         return response;
-    case DecoderCommand::Decode:
-        response.codec = request.codec;
-        response.cmd = DecoderCommand::Decode;
-        response.num_channels = 2; // Just assume stereo here
-        response.size = request.size;
-        response.num_samples = 1024; // Just assume 1024 here
-        return response;
+    case DecoderCommand::Decode: {
+        DecoderOutput output;
+        return DecodeData(request, {}, output);
+    }
     default:
         LOG_ERROR(Audio_DSP, "Got unknown binary request: {}", static_cast<u16>(request.cmd));
         return {};
@@ -34,4 +38,123 @@ std::optional<BinaryResponse> NullDecoder::ProcessRequest(const BinaryRequest& r
     }
 }
 
+std::optional<BinaryResponse> NullDecoder::DecodeData(const BinaryRequest& request,
+                                                      const std::vector<u8>& input,
+                                                      DecoderOutput& output) {
+    BinaryResponse response;
+    response.codec = request.codec;
+    response.cmd = DecoderCommand::Decode;
+    response.num_channels = 2; // Just assume stereo here
+    response.size = request.size;
+    response.num_samples = 1024; // Just assume 1024 here
+    return response;
+}
+
+bool NullDecoder::NeedsInput() const {
+    return false;
+}
+
+bool ReadDecoderInput(Memory::MemorySystem& memory, const BinaryRequest& request,
+                      std::vector<u8>& input) {
+    if (request.src_addr < Memory::FCRAM_PADDR ||
+        request.src_addr + request.size > Memory::FCRAM_N3DS_PADDR_END) {
+        LOG_ERROR(Audio_DSP, "Got out of bounds src_addr {:08x}", request.src_addr);
+        return false;
+    }
+    const u8* data{memory.GetFCRAMPointer(request.src_addr - Memory::FCRAM_PADDR)};
+    input.assign(data, data + request.size);
+    return true;
+}
+
+bool WriteDecoderOutput(Memory::MemorySystem& memory, const BinaryRequest& request,
+                        const DecoderOutput& output) {
+    const std::array<u32, 2> dst_addrs{request.dst_addr_ch0, request.dst_addr_ch1};
+    for (std::size_t channel{}; channel < output.size(); channel++) {
+        const auto& stream{output[channel]};
+        if (stream.empty())
+            continue;
+        if (dst_addrs[channel] < Memory::FCRAM_PADDR ||
+            dst_addrs[channel] + stream.size() > Memory::FCRAM_N3DS_PADDR_END) {
+            LOG_ERROR(Audio_DSP, "Got out of bounds dst_addr_ch{} {:08x}", channel,
+                      dst_addrs[channel]);
+            return false;
+        }
+        std::memcpy(memory.GetFCRAMPointer(dst_addrs[channel] - Memory::FCRAM_PADDR),
+                    stream.data(), stream.size());
+    }
+    return true;
+}
+
+struct AsyncDecoder::Job {
+    BinaryRequest request;
+    std::vector<u8> input;
+    bool input_valid{};
+    DecoderOutput output;
+    std::optional<BinaryResponse> response;
+    std::chrono::steady_clock::duration decode_time{};
+    std::future<void> done;
+};
+
+static std::size_t HistogramBucket(std::chrono::steady_clock::duration time, std::size_t buckets) {
+    const auto us{std::chrono::duration_cast<std::chrono::microseconds>(time).count()};
+    std::size_t bucket{};
+    while (bucket + 1 < buckets && (s64{1} << bucket) <= us)
+        bucket++;
+    return bucket;
+}
+
+static void LogHistogram(const char* name, const u64* counts, std::size_t buckets) {
+    std::string text;
+    for (std::size_t i{}; i < buckets; i++)
+        if (counts[i] != 0)
+            text += fmt::format(" <{}us:{}", u64{1} << i, counts[i]);
+    if (!text.empty())
+        LOG_INFO(Audio_DSP, "AAC {}{}", name, text);
+}
+
+AsyncDecoder::AsyncDecoder(DecoderBase& decoder, Memory::MemorySystem& memory)
+    : decoder{decoder}, memory{memory}, worker{std::make_unique<Common::ThreadPool>(1)} {}
+
+AsyncDecoder::~AsyncDecoder() {
+    // Stop the worker before the jobs it's using go away
+    worker.reset();
+    LogHistogram("decode time", decode_histogram.data(), histogram_buckets);
+    LogHistogram("wait time", wait_histogram.data(), histogram_buckets);
+}
+
+void AsyncDecoder::Queue(const BinaryRequest& request) {
+    auto job{std::make_unique<Job>()};
+    job->request = request;
+    job->input_valid = !decoder.NeedsInput() || ReadDecoderInput(memory, request, job->input);
+    Job* const raw_job{job.get()};
+    job->done = worker->Push([this, raw_job] {
+        if (!raw_job->input_valid)
+            return;
+        const auto start{std::chrono::steady_clock::now()};
+        raw_job->response = decoder.DecodeData(raw_job->request, raw_job->input, raw_job->output);
+        raw_job->decode_time = std::chrono::steady_clock::now() - start;
+    });
+    jobs.push_back(std::move(job));
+}
+
+bool AsyncDecoder::HasPending() const {
+    return !jobs.empty();
+}
+
+std::optional<BinaryResponse> AsyncDecoder::Collect() {
+    if (jobs.empty())
+        return {};
+    const auto job{std::move(jobs.front())};
+    jobs.pop_front();
+    const auto start{std::chrono::steady_clock::now()};
+    job->done.get();
+    ++wait_histogram[HistogramBucket(std::chrono::steady_clock::now() - start, histogram_buckets)];
+    if (!job->input_valid)
+        return {};
+    ++decode_histogram[HistogramBucket(job->decode_time, histogram_buckets)];
+    if (job->response && !WriteDecoderOutput(memory, job->request, job->output))
+        return {};
+    return job->response;
+}
+
 } // namespace AudioCore::HLE
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -11,6 +13,10 @@
 #include "common/swap.h"
 #include "core/core.h"
 
+namespace Common {
+class ThreadPool;
+} // namespace Common
+
 namespace AudioCore::HLE {
 
 enum class DecoderCommand : u16 {
@@ -43,10 +49,25 @@ struct BinaryResponse {
 };
 static_assert(sizeof(BinaryResponse) == 32, "Unexpected struct size for BinaryResponse");
 
+/// Decoded PCM16 samples of a Decode request, one stream per channel
+using DecoderOutput = std::array<std::vector<u8>, 2>;
+
 class DecoderBase {
 public:
     virtual ~DecoderBase();
     virtual std::optional<BinaryResponse> ProcessRequest(const BinaryRequest& request) = 0;
+
+    /**
+     * Decodes the data of a Decode request without touching the emulated memory, so that it can
+     * run on another thread. The output is written with WriteDecoderOutput.
+     * @param input The request.size bytes at request.src_addr
+     */
+    virtual std::optional<BinaryResponse> DecodeData(const BinaryRequest& request,
+                                                     const std::vector<u8>& input,
+                                                     DecoderOutput& output) = 0;
+
+    /// Whether DecodeData currently reads its input, i.e. whether it has to be copied out of FCRAM
+    virtual bool NeedsInput() const = 0;
 };
 
 class NullDecoder final : public DecoderBase {
@@ -55,6 +76,54 @@ public:
     ~NullDecoder() override;
 
     std::optional<BinaryResponse> ProcessRequest(const BinaryRequest& request) override;
+    std::optional<BinaryResponse> DecodeData(const BinaryRequest& request,
+                                             const std::vector<u8>& input,
+                                             DecoderOutput& output) override;
+    bool NeedsInput() const override;
+};
+
+/// Copies the input of a Decode request out of FCRAM, returns false if it's out of bounds
+bool ReadDecoderInput(Memory::MemorySystem& memory, const BinaryRequest& request,
+                      std::vector<u8>& input);
+
+/// Writes decoded samples to the destinations of a Decode request, returns false on bad addresses
+bool WriteDecoderOutput(Memory::MemorySystem& memory, const BinaryRequest& request,
+                        const DecoderOutput& output);
+
+/**
+ * Runs the Decode requests of a decoder on a worker thread, so that the CPU thread doesn't block on
+ * them. The input is copied when a request is queued and the output is written when it's
+ * collected, so the worker never touches the emulated memory. Requests complete in order.
+ */
+class AsyncDecoder {
+public:
+    AsyncDecoder(DecoderBase& decoder, Memory::MemorySystem& memory);
+    ~AsyncDecoder();
+
+    /// Starts decoding a Decode request
+    void Queue(const BinaryRequest& request);
+
+    bool HasPending() const;
+
+    /**
+     * Waits for the oldest queued request if it isn't done yet and writes its output.
+     * @returns The response of the request
+     */
+    std::optional<BinaryResponse> Collect();
+
+private:
+    struct Job;
+
+    DecoderBase& decoder;
+    Memory::MemorySystem& memory;
+    std::deque<std::unique_ptr<Job>> jobs;
+
+    // Decode time and time the CPU thread waited on Collect, in power of two microsecond buckets
+    static constexpr std::size_t histogram_buckets{12};
+    std::array<u64, histogram_buckets> decode_histogram{};
+    std::array<u64, histogram_buckets> wait_histogram{};
+
+    std::unique_ptr<Common::ThreadPool> worker;
 };
 
 } // namespace AudioCore::HLE
@@ -14,6 +14,14 @@ public:
 
     std::optional<BinaryResponse> ProcessRequest(const BinaryRequest& request);
 
+    std::optional<BinaryResponse> DecodeData(const BinaryRequest& request,
+                                             const std::vector<u8>& input,
+                                             DecoderOutput& out_streams);
+
+    bool NeedsInput() const {
+        return initialized;
+    }
+
 private:
     std::optional<BinaryResponse> Initalize(const BinaryRequest& request);
 
@@ -128,6 +136,19 @@ void FfmpegDecoder::Impl::Clear() {
 }
 
 std::optional<BinaryResponse> FfmpegDecoder::Impl::Decode(const BinaryRequest& request) {
+    std::vector<u8> input;
+    if (NeedsInput() && !ReadDecoderInput(memory, request, input))
+        return {};
+    DecoderOutput out_streams;
+    auto response{DecodeData(request, input, out_streams)};
+    if (response && !WriteDecoderOutput(memory, request, out_streams))
+        return {};
+    return response;
+}
+
+std::optional<BinaryResponse> FfmpegDecoder::Impl::DecodeData(const BinaryRequest& request,
+                                                              const std::vector<u8>& input,
+                                                              DecoderOutput& out_streams) {
     BinaryResponse response;
     response.codec = request.codec;
     response.cmd = request.cmd;
@@ -139,14 +160,8 @@ std::optional<BinaryResponse> FfmpegDecoder::Impl::Decode(const BinaryRequest& r
         response.num_samples = 1024;
         return response;
     }
-    if (request.src_addr < Memory::FCRAM_PADDR ||
-        request.src_addr + request.size > Memory::FCRAM_N3DS_PADDR_END) {
-        LOG_ERROR(Audio_DSP, "Got out of bounds src_addr {:08x}", request.src_addr);
-        return {};
-    }
-    u8* data{memory.GetFCRAMPointer(request.src_addr - Memory::FCRAM_PADDR)};
-    std::array<std::vector<u8>, 2> out_streams;
-    std::size_t data_size{request.size};
+    const u8* data{input.data()};
+    std::size_t data_size{input.size()};
     while (data_size > 0) {
         if (!decoded_frame) {
             decoded_frame.reset(av_frame_alloc_dl());
@@ -203,24 +218,6 @@ std::optional<BinaryResponse> FfmpegDecoder::Impl::Decode(const BinaryRequest& r
             }
         }
     }
-    if (out_streams[0].size() != 0) {
-        if (request.dst_addr_ch0 < Memory::FCRAM_PADDR ||
-            request.dst_addr_ch0 + out_streams[0].size() > Memory::FCRAM_N3DS_PADDR_END) {
-            LOG_ERROR(Audio_DSP, "Got out of bounds dst_addr_ch0 {:08x}", request.dst_addr_ch0);
-            return {};
-        }
-        std::memcpy(memory.GetFCRAMPointer(request.dst_addr_ch0 - Memory::FCRAM_PADDR),
-                    out_streams[0].data(), out_streams[0].size());
-    }
-    if (out_streams[1].size() != 0) {
-        if (request.dst_addr_ch1 < Memory::FCRAM_PADDR ||
-            request.dst_addr_ch1 + out_streams[1].size() > Memory::FCRAM_N3DS_PADDR_END) {
-            LOG_ERROR(Audio_DSP, "Got out of bounds dst_addr_ch1 {:08x}", request.dst_addr_ch1);
-            return {};
-        }
-        std::memcpy(memory.GetFCRAMPointer(request.dst_addr_ch1 - Memory::FCRAM_PADDR),
-                    out_streams[1].data(), out_streams[1].size());
-    }
     return response;
 }
 
@@ -232,4 +229,14 @@ std::optional<BinaryResponse> FfmpegDecoder::ProcessRequest(const BinaryRequest&
     return impl->ProcessRequest(request);
 }
 
+std::optional<BinaryResponse> FfmpegDecoder::DecodeData(const BinaryRequest& request,
+                                                        const std::vector<u8>& input,
+                                                        DecoderOutput& output) {
+    return impl->DecodeData(request, input, output);
+}
+
+bool FfmpegDecoder::NeedsInput() const {
+    return impl->NeedsInput();
+}
+
 } // namespace AudioCore::HLE
@@ -14,6 +14,10 @@ public:
     ~FfmpegDecoder() override;
 
     std::optional<BinaryResponse> ProcessRequest(const BinaryRequest& request) override;
+    std::optional<BinaryResponse> DecodeData(const BinaryRequest& request,
+                                             const std::vector<u8>& input,
+                                             DecoderOutput& output) override;
+    bool NeedsInput() const override;
 
 private:
     class Impl;
@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <future>
+#include <thread>
 #include "audio_core/audio_types.h"
 #ifdef HAVE_FFMPEG
 #include "audio_core/hle/ffmpeg_decoder.h"
@@ -16,6 +19,7 @@
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/thread_pool.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/dsp/dsp_dsp.h"
@@ -38,7 +42,7 @@ public:
     u16 RecvData(u32 register_number);
     bool RecvDataIsReady(u32 register_number) const;
     std::vector<u8> PipeRead(DspPipe pipe_number, u32 length);
-    std::size_t GetPipeReadableSize(DspPipe pipe_number) const;
+    std::size_t GetPipeReadableSize(DspPipe pipe_number);
     void PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer);
 
     std::array<u8, Memory::DSP_RAM_SIZE>& GetDspMemory();
@@ -47,6 +51,8 @@ public:
 
 private:
     void ResetPipes();
+    /// Writes the responses of all queued decode requests to the binary pipe
+    void FlushDecodes();
     void WriteU16(DspPipe pipe_number, u16 value);
     void AudioPipeWriteStructAddresses();
 
@@ -72,10 +78,14 @@ private:
 
     HLE::Mixers mixers;
 
+    /// Created on first use when sources are generated in parallel
+    std::unique_ptr<Common::ThreadPool> source_pool;
+
     DspHle& parent;
     Core::TimingEventType* tick_event;
 
     std::unique_ptr<HLE::DecoderBase> decoder;
+    std::unique_ptr<HLE::AsyncDecoder> async_decoder;
 
     std::weak_ptr<DSP_DSP> dsp_dsp;
 
@@ -92,6 +102,7 @@ DspHle::Impl::Impl(DspHle& parent, Core::System& system) : system{system}, paren
     LOG_WARNING(Audio_DSP, "FFmpeg missing, this could lead to missing audio");
     decoder = std::make_unique<HLE::NullDecoder>();
 #endif // HAVE_FFMPEG
+    async_decoder = std::make_unique<HLE::AsyncDecoder>(*decoder, memory);
     dsp_memory.raw_memory.fill(0);
     auto& timing{system.CoreTiming()};
     tick_event = timing.RegisterEvent(
@@ -138,6 +149,8 @@ std::vector<u8> DspHle::Impl::PipeRead(DspPipe pipe_number, u32 length) {
         LOG_ERROR(Audio_DSP, "length of {} greater than max of {}", length, UINT16_MAX);
         return {};
     }
+    if (pipe_number == DspPipe::Binary)
+        FlushDecodes();
     std::vector<u8>& data{pipe_data[pipe_index]};
     if (length > data.size()) {
         LOG_WARNING(Audio_DSP, "pipe {} is out of data, program requested read of {} but {} remain",
@@ -151,12 +164,14 @@ std::vector<u8> DspHle::Impl::PipeRead(DspPipe pipe_number, u32 length) {
     return ret;
 }
 
-std::size_t DspHle::Impl::GetPipeReadableSize(DspPipe pipe_number) const {
+std::size_t DspHle::Impl::GetPipeReadableSize(DspPipe pipe_number) {
     const auto pipe_index{static_cast<std::size_t>(pipe_number)};
     if (pipe_index >= num_dsp_pipe) {
         LOG_ERROR(Audio_DSP, "pipe_number {} invalid", pipe_index);
         return 0;
     }
+    if (pipe_number == DspPipe::Binary)
+        FlushDecodes();
     return pipe_data[pipe_index].size();
 }
 
@@ -208,12 +223,12 @@ void DspHle::Impl::PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer)
             dsp_state = DspState::Off;
             break;
         }
+        FlushDecodes();
         std::copy(buffer.begin(), buffer.end(),
                   std::back_inserter(pipe_data[static_cast<std::size_t>(DspPipe::Binary)]));
         return;
     }
     case DspPipe::Binary: {
-        // TODO: Make this async, and signal the interrupt
         HLE::BinaryRequest request;
         if (sizeof(request) != buffer.size()) {
             LOG_CRITICAL(Audio_DSP, "got binary pipe with wrong size {}", buffer.size());
@@ -226,6 +241,13 @@ void DspHle::Impl::PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer)
             UNIMPLEMENTED();
             return;
         }
+        // Decoding runs on the worker, its response is delivered by the next audio tick or when
+        // the program reads the binary pipe, whichever comes first
+        if (request.cmd == HLE::DecoderCommand::Decode) {
+            async_decoder->Queue(request);
+            return;
+        }
+        FlushDecodes();
         auto response{decoder->ProcessRequest(request)};
         if (response) {
             const auto& value{*response};
@@ -249,11 +271,24 @@ void DspHle::Impl::SetServiceToInterrupt(std::weak_ptr<DSP_DSP> dsp) {
 }
 
 void DspHle::Impl::ResetPipes() {
+    FlushDecodes();
     for (auto& data : pipe_data)
         data.clear();
     dsp_state = DspState::Off;
 }
 
+void DspHle::Impl::FlushDecodes() {
+    auto& data{pipe_data[static_cast<std::size_t>(DspPipe::Binary)]};
+    while (async_decoder->HasPending()) {
+        const auto response{async_decoder->Collect()};
+        if (response) {
+            const auto& value{*response};
+            data.resize(sizeof(value));
+            std::memcpy(data.data(), &value, sizeof(value));
+        }
+    }
+}
+
 void DspHle::Impl::WriteU16(DspPipe pipe_number, u16 value) {
     const auto pipe_index{static_cast<std::size_t>(pipe_number)};
     auto& data{pipe_data.at(pipe_index)};
@@ -318,13 +353,28 @@ StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
     auto& read{ReadRegion()};
     auto& write{WriteRegion()};
     std::array<QuadFrame32, 3> intermediate_mixes{};
-    // Generate intermediate mixes
-    for (std::size_t i{}; i < num_sources; i++) {
+    // Generate the frames of the sources, which only touch their own state and shared memory slot
+    const auto tick_source{[&](std::size_t i) {
         write.source_statuses.statuses[i] =
             sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+    }};
+    if (Settings::values.enable_parallel_audio_sources) {
+        if (!source_pool)
+            source_pool = std::make_unique<Common::ThreadPool>(
+                std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 4));
+        std::array<std::future<void>, num_sources> ticks;
+        for (std::size_t i{}; i < num_sources; i++)
+            ticks[i] = source_pool->Push(tick_source, i);
+        for (auto& tick : ticks)
+            tick.get();
+    } else {
+        for (std::size_t i{}; i < num_sources; i++)
+            tick_source(i);
+    }
+    // Generate intermediate mixes in source order, so the result doesn't depend on scheduling
+    for (std::size_t i{}; i < num_sources; i++)
         for (std::size_t mix{}; mix < 3; mix++)
             sources[i].MixInto(intermediate_mixes[mix], mix);
-    }
     // Generate final mix
     write.dsp_status = mixers.Tick(read.dsp_configuration, read.intermediate_mix_samples,
                                    write.intermediate_mix_samples, intermediate_mixes);
@@ -345,6 +395,7 @@ bool DspHle::Impl::Tick() {
 }
 
 void DspHle::Impl::AudioTickCallback(s64 cycles_late) {
+    FlushDecodes();
     if (Tick())
         // TODO: Signal all the other interrupts as appropriate.
         if (auto service{dsp_dsp.lock()}) {
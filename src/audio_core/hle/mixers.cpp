@@ -4,6 +4,9 @@
 
 #include <algorithm>
 #include <cstddef>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include "audio_core/hle/mixers.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -84,6 +87,92 @@ void Mixers::ParseConfig(DspConfiguration& config) {
     config.dirty_raw = 0;
 }
 
+#ifdef ARCHITECTURE_x86_64
+/**
+ * Loads four quadraphonic samples as one vector per channel, converted to float and scaled by gain.
+ * The products are exactly the ones the scalar downmix computes.
+ */
+static void LoadScaledChannels(const std::array<s32, 4>* samples, __m128 gain,
+                               std::array<__m128, 4>& channels) {
+    for (std::size_t i{}; i < 4; i++)
+        channels[i] = _mm_castsi128_ps(_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(samples[i].data())));
+    _MM_TRANSPOSE4_PS(channels[0], channels[1], channels[2], channels[3]);
+    for (auto& channel : channels)
+        channel = _mm_mul_ps(gain, _mm_cvtepi32_ps(_mm_castps_si128(channel)));
+}
+
+/// Saturates four left/right pairs to s16 and adds them to the frame with saturation
+static void MixIntoFrame(std::array<s16, 2>* frame, __m128i left, __m128i right) {
+    const __m128i pcm16{
+        _mm_packs_epi32(_mm_unpacklo_epi32(left, right), _mm_unpackhi_epi32(left, right))};
+    auto* out{reinterpret_cast<__m128i*>(frame)};
+    _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), pcm16));
+}
+
+/// Transposes a channel-major block of samples into quadraphonic samples
+static void ChannelsToQuad(const s32_le (&in)[4][samples_per_frame], QuadFrame32& out) {
+    for (std::size_t sample{}; sample < samples_per_frame; sample += 4) {
+        std::array<__m128, 4> rows;
+        for (std::size_t channel{}; channel < 4; channel++)
+            rows[channel] = _mm_loadu_ps(reinterpret_cast<const float*>(&in[channel][sample]));
+        _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+        for (std::size_t i{}; i < 4; i++)
+            _mm_storeu_ps(reinterpret_cast<float*>(out[sample + i].data()), rows[i]);
+    }
+}
+
+/// Transposes quadraphonic samples into a channel-major block of samples
+static void QuadToChannels(const QuadFrame32& in, s32_le (&out)[4][samples_per_frame]) {
+    for (std::size_t sample{}; sample < samples_per_frame; sample += 4) {
+        std::array<__m128, 4> rows;
+        for (std::size_t i{}; i < 4; i++)
+            rows[i] = _mm_loadu_ps(reinterpret_cast<const float*>(in[sample + i].data()));
+        _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+        for (std::size_t channel{}; channel < 4; channel++)
+            _mm_storeu_ps(reinterpret_cast<float*>(&out[channel][sample]), rows[channel]);
+    }
+}
+
+static_assert(samples_per_frame % 4 == 0, "Mixing kernels process four samples at a time");
+
+void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& samples) {
+    // TODO: Limiter. (Currently we're performing final mixing assuming a disabled limiter.)
+
+    const __m128 gain_vector{_mm_set1_ps(gain)};
+    std::array<__m128, 4> ch;
+
+    switch (state.output_format) {
+    case OutputFormat::Mono:
+        for (std::size_t samplei{}; samplei < samples_per_frame; samplei += 4) {
+            LoadScaledChannels(&samples[samplei], gain_vector, ch);
+            // Downmix to mono, summing in the same order as the scalar code
+            const __m128 sum{_mm_add_ps(_mm_add_ps(_mm_add_ps(ch[0], ch[1]), ch[2]), ch[3])};
+            const __m128i mono{_mm_cvttps_epi32(_mm_div_ps(sum, _mm_set1_ps(2.0f)))};
+            // Mix into current frame
+            MixIntoFrame(&current_frame[samplei], mono, mono);
+        }
+        return;
+
+    case OutputFormat::Surround:
+        // TODO: Implement surround sound.
+        // fallthrough
+
+    case OutputFormat::Stereo:
+        for (std::size_t samplei{}; samplei < samples_per_frame; samplei += 4) {
+            LoadScaledChannels(&samples[samplei], gain_vector, ch);
+            // Downmix to stereo
+            const __m128i left{_mm_cvttps_epi32(_mm_add_ps(ch[0], ch[2]))};
+            const __m128i right{_mm_cvttps_epi32(_mm_add_ps(ch[1], ch[3]))};
+            // Mix into current frame
+            MixIntoFrame(&current_frame[samplei], left, right);
+        }
+        return;
+    }
+
+    UNREACHABLE_MSG("Invalid output_format {}", static_cast<std::size_t>(state.output_format));
+}
+#else
 static s16 ClampToS16(s32 value) {
     return static_cast<s16>(std::clamp(value, -32768, 32767));
 }
@@ -133,26 +222,29 @@ void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& sample
     UNREACHABLE_MSG("Invalid output_format {}", static_cast<std::size_t>(state.output_format));
 }
 
+static void ChannelsToQuad(const s32_le (&in)[4][samples_per_frame], QuadFrame32& out) {
+    for (std::size_t sample{}; sample < samples_per_frame; sample++)
+        for (std::size_t channel{}; channel < 4; channel++)
+            out[sample][channel] = in[channel][sample];
+}
+
+static void QuadToChannels(const QuadFrame32& in, s32_le (&out)[4][samples_per_frame]) {
+    for (std::size_t sample{}; sample < samples_per_frame; sample++)
+        for (std::size_t channel{}; channel < 4; channel++)
+            out[channel][sample] = in[sample][channel];
+}
+#endif // ARCHITECTURE_x86_64
+
 void Mixers::AuxReturn(const IntermediateMixSamples& read_samples) {
     // NOTE: read_samples.mix{1,2}.pcm32 annoyingly have their dimensions in reverse order to
     // QuadFrame32.
 
     if (state.mixer1_enabled) {
-        for (std::size_t sample{}; sample < samples_per_frame; sample++) {
-            for (std::size_t channel{}; channel < 4; channel++) {
-                state.intermediate_mix_buffer[1][sample][channel] =
-                    read_samples.mix1.pcm32[channel][sample];
-            }
-        }
+        ChannelsToQuad(read_samples.mix1.pcm32, state.intermediate_mix_buffer[1]);
     }
 
     if (state.mixer2_enabled) {
-        for (std::size_t sample{}; sample < samples_per_frame; sample++) {
-            for (std::size_t channel{}; channel < 4; channel++) {
-                state.intermediate_mix_buffer[2][sample][channel] =
-                    read_samples.mix2.pcm32[channel][sample];
-            }
-        }
+        ChannelsToQuad(read_samples.mix2.pcm32, state.intermediate_mix_buffer[2]);
     }
 }
 
@@ -164,21 +256,13 @@ void Mixers::AuxSend(IntermediateMixSamples& write_samples,
     state.intermediate_mix_buffer[0] = input[0];
 
     if (state.mixer1_enabled) {
-        for (std::size_t sample{}; sample < samples_per_frame; sample++) {
-            for (std::size_t channel{}; channel < 4; channel++) {
-                write_samples.mix1.pcm32[channel][sample] = input[1][sample][channel];
-            }
-        }
+        QuadToChannels(input[1], write_samples.mix1.pcm32);
     } else {
         state.intermediate_mix_buffer[1] = input[1];
     }
 
     if (state.mixer2_enabled) {
-        for (std::size_t sample{}; sample < samples_per_frame; sample++) {
-            for (std::size_t channel{}; channel < 4; channel++) {
-                write_samples.mix2.pcm32[channel][sample] = input[2][sample][channel];
-            }
-        }
+        QuadToChannels(input[2], write_samples.mix2.pcm32);
     } else {
         state.intermediate_mix_buffer[2] = input[2];
     }
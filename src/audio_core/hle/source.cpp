@@ -4,6 +4,10 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include "audio_core/codec.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
@@ -25,6 +29,21 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
     if (!state.enabled)
         return;
     const std::array<float, 4>& gains{state.gain.at(intermediate_mix_id)};
+#ifdef ARCHITECTURE_x86_64
+    // Same float multiply and truncation as below, one quadraphonic sample per vector
+    const __m128 gain{_mm_loadu_ps(gains.data())};
+    for (std::size_t samplei{}; samplei < samples_per_frame; samplei++) {
+        s32 stereo;
+        std::memcpy(&stereo, current_frame[samplei].data(), sizeof(stereo));
+        __m128i in{_mm_cvtsi32_si128(stereo)};
+        // Sign extend L, R to 32 bits and spread them to L, R, L, R
+        in = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+        in = _mm_shuffle_epi32(in, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m128i scaled{_mm_cvttps_epi32(_mm_mul_ps(gain, _mm_cvtepi32_ps(in)))};
+        auto* out{reinterpret_cast<__m128i*>(dest[samplei].data())};
+        _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), scaled));
+    }
+#else
     for (std::size_t samplei{}; samplei < samples_per_frame; samplei++) {
         // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
         dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
@@ -32,6 +51,7 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
         dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
         dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
     }
+#endif
 }
 
 void Source::Reset() {
@@ -219,10 +239,8 @@ void Source::GenerateFrame() {
                                 current_frame, frame_position);
             break;
         case InterpolationMode::Polyphase:
-            // TODO: Implement polyphase interpolation
-            LOG_DEBUG(Audio_DSP, "Polyphase interpolation unimplemented; falling back to linear");
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
-                                current_frame, frame_position);
+            AudioInterp::Polyphase(state.interp_state, state.current_buffer,
+                                   state.rate_multiplier, current_frame, frame_position);
             break;
         default:
             UNIMPLEMENTED();
@@ -254,15 +272,15 @@ bool Source::DequeueBuffer() {
             static_cast<unsigned>(buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1)};
         switch (buf.format) {
         case Format::PCM8:
-            state.current_buffer = Codec::DecodePCM8(num_channels, memory, buf.length);
+            Codec::DecodePCM8(num_channels, memory, buf.length, state.current_buffer);
             break;
         case Format::PCM16:
-            state.current_buffer = Codec::DecodePCM16(num_channels, memory, buf.length);
+            Codec::DecodePCM16(num_channels, memory, buf.length, state.current_buffer);
             break;
         case Format::ADPCM:
             DEBUG_ASSERT(num_channels == 1);
-            state.current_buffer =
-                Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state);
+            Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state,
+                               state.current_buffer);
             break;
         default:
             UNIMPLEMENTED();
@@ -111,7 +111,7 @@ private:
         // Current buffer
         u32 current_sample_number{};
         u32 next_sample_number{};
-        AudioInterp::StereoBuffer16 current_buffer;
+        StereoBuffer16 current_buffer;
 
         // buffer_id state
         bool buffer_update{};
@@ -3,6 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
 
@@ -13,8 +18,9 @@ namespace AudioCore::AudioInterp {
 constexpr u64 scale_factor{1 << 24};
 constexpr u64 scale_mask{scale_factor - 1};
 
-/// Here we step over the input in steps of rate, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
+/// Here we step over the input in steps of rate, until we consume all of the input or fill the
+/// output. Each step fn is passed the fraction and a pointer x to the current sample, x[-1] to x[2]
+/// are valid.
 template <typename Function>
 static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
                             std::size_t& outputi, Function fn) {
@@ -23,7 +29,14 @@ static void StepOverSamples(State& state, StereoBuffer16& input, float rate, Ste
     if (input.empty())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    // The history goes into the free slots in front of the unread samples, so the whole block can
+    // be stepped over without copying it
+    static_assert(StereoBuffer16::HISTORY == 3);
+    auto* const samples{input.data() - 2};
+    const std::size_t num_samples{input.size() + 2};
+    samples[-1] = state.xn3;
+    samples[0] = state.xn2;
+    samples[1] = state.xn1;
 
     const u64 step_size{static_cast<u64>(rate * scale_factor)};
     u64 fposition{state.fposition};
@@ -32,45 +45,126 @@ static void StepOverSamples(State& state, StereoBuffer16& input, float rate, Ste
     while (outputi < output.size()) {
         inputi = static_cast<std::size_t>(fposition / scale_factor);
 
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
+        if (inputi + 2 >= num_samples) {
+            inputi = num_samples - 2;
             break;
         }
 
         u64 fraction{fposition & scale_mask};
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+        output[outputi++] = fn(fraction, samples + inputi);
 
         fposition += step_size;
     }
 
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
+    const auto* const last{samples + inputi};
+    state.xn3 = last[-1];
+    state.xn2 = last[0];
+    state.xn1 = last[1];
     state.fposition = fposition - inputi * scale_factor;
 
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+    input.Consume(inputi);
+}
+
+// The polyphase filter bank has 256 phases of four taps in fixed point with 14 fractional bits
+constexpr std::size_t polyphase_phases{256};
+constexpr int polyphase_shift{14};
+
+/// Each phase holds the taps for x[-1] to x[2] as c0 c1 c0 c1 c2 c3 c2 c3, which lines up with
+/// four stereo samples once the channels of each pair of samples are separated
+using PolyphaseBank = std::array<std::array<s16, 8>, polyphase_phases>;
+
+static PolyphaseBank MakePolyphaseBank() {
+    constexpr double pi{3.14159265358979323846};
+    const auto lanczos{[pi](double x) {
+        if (x == 0)
+            return 1.0;
+        if (std::abs(x) >= 2)
+            return 0.0;
+        return 2 * std::sin(pi * x) * std::sin(pi * x / 2) / (pi * pi * x * x);
+    }};
+
+    PolyphaseBank bank{};
+    for (std::size_t phase{}; phase < polyphase_phases; phase++) {
+        const double f{static_cast<double>(phase) / polyphase_phases};
+        std::array<double, 4> weights;
+        for (std::size_t tap{}; tap < 4; tap++)
+            weights[tap] = lanczos(f + 1.0 - tap);
+        const double total{weights[0] + weights[1] + weights[2] + weights[3]};
+
+        // Normalise to unity gain, and put the rounding error on the larger centre tap
+        std::array<s16, 4> taps;
+        s32 sum{};
+        for (std::size_t tap{}; tap < 4; tap++) {
+            taps[tap] = static_cast<s16>(std::lround(weights[tap] / total * (1 << polyphase_shift)));
+            sum += taps[tap];
+        }
+        taps[f < 0.5 ? 1 : 2] += static_cast<s16>((1 << polyphase_shift) - sum);
+
+        bank[phase] = {taps[0], taps[1], taps[0], taps[1], taps[2], taps[3], taps[2], taps[3]};
+    }
+    return bank;
+}
+
+alignas(16) static const PolyphaseBank polyphase_bank{MakePolyphaseBank()};
+
+static std::array<s16, 2> PolyphaseSample(const std::array<s16, 8>& taps,
+                                          const StereoBuffer16::Sample* x) {
+    constexpr s32 rounding{1 << (polyphase_shift - 1)};
+#ifdef ARCHITECTURE_x86_64
+    // L-1 R-1 L0 R0 L1 R1 L2 R2 -> L-1 L0 R-1 R0 L1 L2 R1 R2
+    __m128i in{_mm_loadu_si128(reinterpret_cast<const __m128i*>((x - 1)->data()))};
+    in = _mm_shufflelo_epi16(in, _MM_SHUFFLE(3, 1, 2, 0));
+    in = _mm_shufflehi_epi16(in, _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i sum{_mm_madd_epi16(in, _mm_load_si128(reinterpret_cast<const __m128i*>(taps.data())))};
+    sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+    sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(rounding)), polyphase_shift);
+    const s32 packed{_mm_cvtsi128_si32(_mm_packs_epi32(sum, sum))};
+    std::array<s16, 2> result;
+    std::memcpy(result.data(), &packed, sizeof(packed));
+    return result;
+#else
+    std::array<s16, 2> result;
+    for (std::size_t channel{}; channel < 2; channel++) {
+        const s32 sum{taps[0] * x[-1][channel] + taps[1] * x[0][channel] +
+                      taps[4] * x[1][channel] + taps[5] * x[2][channel]};
+        result[channel] =
+            static_cast<s16>(std::clamp((sum + rounding) >> polyphase_shift, -32768, 32767));
+    }
+    return result;
+#endif
 }
 
 void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
           std::size_t& outputi) {
     StepOverSamples(
         state, input, rate, output, outputi,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+        [](u64 fraction, const StereoBuffer16::Sample* x) { return x[0]; });
 }
 
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi) {
     // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
     StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
+                    [](u64 fraction, const StereoBuffer16::Sample* x) {
                         // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                        s64 delta0{std::clamp<s64>(x1[0] - x0[0], -32768, 32767)};
-                        s64 delta1{std::clamp<s64>(x1[1] - x0[1], -32768, 32767)};
+                        s64 delta0{std::clamp<s64>(x[1][0] - x[0][0], -32768, 32767)};
+                        s64 delta1{std::clamp<s64>(x[1][1] - x[0][1], -32768, 32767)};
 
                         return std::array<s16, 2>{
-                            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
+                            static_cast<s16>(x[0][0] + fraction * delta0 / scale_factor),
+                            static_cast<s16>(x[0][1] + fraction * delta1 / scale_factor),
                         };
                     });
 }
 
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi) {
+    StepOverSamples(state, input, rate, output, outputi,
+                    [](u64 fraction, const StereoBuffer16::Sample* x) {
+                        const std::size_t phase{
+                            static_cast<std::size_t>(fraction * polyphase_phases / scale_factor)};
+                        return PolyphaseSample(polyphase_bank[phase], x);
+                    });
+}
+
 } // namespace AudioCore::AudioInterp
@@ -4,6 +4,8 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
+#include <mutex>
 #include <thread>
 #include <teakra/teakra.h>
 #include "audio_core/lle/lle.h"
@@ -11,6 +13,7 @@
 #include "common/bit_field.h"
 #include "common/swap.h"
 #include "common/thread.h"
+#include "common/threadsafe_queue.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/lock.h"
@@ -120,6 +123,11 @@ static u8 PipeIndexToSlotIndex(u8 pipe_index, PipeDirection direction) {
     return (pipe_index << 1) + static_cast<u8>(direction);
 }
 
+using InterruptType = Service::DSP::DSP_DSP::InterruptType;
+
+/// Set on the thread running Teakra ahead of the CPU in multithread mode
+static thread_local bool is_teakra_thread{};
+
 struct DspLle::Impl final {
     explicit Impl(Core::System& system, bool multithread)
         : system{system}, multithread{multithread} {
@@ -141,42 +149,127 @@ struct DspLle::Impl final {
     Core::TimingEventType* teakra_slice_event;
     std::atomic_bool loaded{}, stop_signal{};
 
-    const bool multithread;
-    std::thread teakra_thread;
-    Common::Barrier teakra_slice_barrier{2};
-    std::size_t stop_generation;
+    std::weak_ptr<Service::DSP::DSP_DSP> dsp_dsp;
 
     static constexpr u32 DspDataOffset{0x40000};
     static constexpr u32 TeakraSlice{20000};
 
+    // In multithread mode the Teakra thread runs asynchronously, up to MaxRunAhead DSP cycles
+    // ahead of the cycles granted by the CPU thread's slice events. The CPU thread only waits for
+    // it when it touches the DSP state, or when the DSP falls more than MaxLag cycles behind.
+    static constexpr u64 MaxRunAhead{TeakraSlice * 4};
+    static constexpr u64 MaxLag{TeakraSlice * 4};
+    static constexpr u32 MinSlice{TeakraSlice / 8};
+
+    const bool multithread;
+    std::thread teakra_thread;
+    /// Held while Teakra runs or its state is accessed, in multithread mode
+    std::mutex teakra_mutex;
+    std::atomic<u64> cycles_granted{}, cycles_run{};
+    /// Set when the CPU thread had to wait for a slice to finish, to shorten the next ones
+    std::atomic_bool contended{};
+    Common::Event budget_event;
+
+    struct PendingInterrupt {
+        InterruptType type;
+        DspPipe pipe;
+    };
+    Common::SPSCQueue<PendingInterrupt> pending_interrupts;
+
+    struct SyncStats {
+        u64 syncs{};
+        u64 contended_syncs{};
+        u64 lag_waits{};
+        std::chrono::steady_clock::duration wait{};
+        std::chrono::steady_clock::duration max_wait{};
+    };
+    /// Only touched by the CPU thread
+    SyncStats sync_stats;
+
     void TeakraThread() {
-        for (;;) {
-            teakra.Run(TeakraSlice);
-            teakra_slice_barrier.Sync();
-            if (stop_signal && stop_generation == teakra_slice_barrier.Generation())
-                break;
+        is_teakra_thread = true;
+        u32 slice{TeakraSlice};
+        while (!stop_signal) {
+            const u64 run{cycles_run};
+            const u64 limit{cycles_granted + MaxRunAhead};
+            if (run >= limit) {
+                budget_event.Wait();
+                continue;
+            }
+            const u32 this_slice{static_cast<u32>(std::min<u64>(slice, limit - run))};
+            {
+                std::lock_guard lock{teakra_mutex};
+                teakra.Run(this_slice);
+                cycles_run += this_slice;
+            }
+            // Short slices while the CPU thread keeps accessing the DSP, long ones otherwise
+            if (contended.exchange(false))
+                slice = std::max(slice / 2, MinSlice);
+            else
+                slice = std::min(slice * 2, TeakraSlice);
         }
-        stop_signal = false;
     }
 
     void StopTeakraThread() {
-        if (teakra_thread.joinable()) {
-            stop_generation = teakra_slice_barrier.Generation() + 1;
-            stop_signal = true;
-            teakra_slice_barrier.Sync();
-            teakra_thread.join();
+        if (!teakra_thread.joinable())
+            return;
+        stop_signal = true;
+        budget_event.Set();
+        teakra_thread.join();
+        stop_signal = false;
+        PendingInterrupt interrupt;
+        while (pending_interrupts.Pop(interrupt)) {
+        }
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        LOG_INFO(Audio_DSP,
+                 "DSP thread: {} syncs, {} contended, {} us waited (max {} us), {} lag waits",
+                 sync_stats.syncs, sync_stats.contended_syncs,
+                 duration_cast<microseconds>(sync_stats.wait).count(),
+                 duration_cast<microseconds>(sync_stats.max_wait).count(), sync_stats.lag_waits);
+        sync_stats = {};
+    }
+
+    /**
+     * Gives the CPU thread exclusive access to the Teakra state. This is only needed in
+     * multithread mode, and not on the Teakra thread itself, which already holds it while running.
+     */
+    std::unique_lock<std::mutex> LockTeakra() {
+        if (!multithread || is_teakra_thread)
+            return {};
+        std::unique_lock lock{teakra_mutex, std::try_to_lock};
+        ++sync_stats.syncs;
+        if (!lock.owns_lock()) {
+            contended = true;
+            const auto start{std::chrono::steady_clock::now()};
+            lock.lock();
+            const auto wait{std::chrono::steady_clock::now() - start};
+            ++sync_stats.contended_syncs;
+            sync_stats.wait += wait;
+            sync_stats.max_wait = std::max(sync_stats.max_wait, wait);
         }
+        return lock;
     }
 
+    /// Runs Teakra on the calling thread, which must have it locked in multithread mode
     void RunTeakraSlice() {
+        teakra.Run(TeakraSlice);
         if (multithread)
-            teakra_slice_barrier.Sync();
-        else
-            teakra.Run(TeakraSlice);
+            cycles_run += TeakraSlice;
     }
 
     void TeakraSliceEvent(u64 late) {
-        RunTeakraSlice();
+        if (multithread) {
+            cycles_granted += TeakraSlice;
+            budget_event.Set();
+            if (cycles_run + MaxLag < cycles_granted) {
+                ++sync_stats.lag_waits;
+                while (cycles_run + MaxLag < cycles_granted)
+                    std::this_thread::yield();
+            }
+            DeliverPendingInterrupts();
+        } else
+            RunTeakraSlice();
         u64 next{TeakraSlice * 2}; // DSP runs at clock rate half of the CPU rate
         if (next < late)
             next = 0;
@@ -185,6 +278,25 @@ struct DspLle::Impl final {
         system.CoreTiming().ScheduleEvent(next, teakra_slice_event, 0);
     }
 
+    void SignalInterrupt(const char* site, InterruptType type, DspPipe pipe) {
+        // Taking the HLE lock here could stall the Teakra thread on the CPU thread, so its
+        // interrupts are handed over to the next slice event instead
+        if (is_teakra_thread) {
+            pending_interrupts.Push(PendingInterrupt{type, pipe});
+            return;
+        }
+        HLE::HLELockGuard lock{site};
+        if (auto dsp{dsp_dsp.lock()})
+            dsp->SignalInterrupt(type, pipe);
+    }
+
+    void DeliverPendingInterrupts() {
+        PendingInterrupt interrupt;
+        while (pending_interrupts.Pop(interrupt))
+            if (auto dsp{dsp_dsp.lock()})
+                dsp->SignalInterrupt(interrupt.type, interrupt.pipe);
+    }
+
     u8* GetDspDataPointer(u32 baddr) {
         auto& memory{teakra.GetDspMemory()};
         return &memory[DspDataOffset + baddr];
@@ -295,6 +407,7 @@ struct DspLle::Impl final {
             LOG_ERROR(Audio_DSP, "Component already loaded!");
             return;
         }
+        auto lock{LockTeakra()};
         teakra.Reset();
         Dsp1 dsp{buffer};
         auto& dsp_memory{teakra.GetDspMemory()};
@@ -308,8 +421,12 @@ struct DspLle::Impl final {
                 std::memcpy(data + segment.target * 2, segment.data.data(), segment.data.size());
         // TODO: load special segment
         system.CoreTiming().ScheduleEvent(TeakraSlice, teakra_slice_event, 0);
-        if (multithread)
+        if (multithread) {
+            cycles_granted = 0;
+            cycles_run = 0;
+            // It waits for the lock until the component is initialized
             teakra_thread = std::thread(&Impl::TeakraThread, this);
+        }
         // Wait for initialization
         if (dsp.recv_data_on_start)
             for (u8 i{}; i < 3; ++i)
@@ -330,43 +447,52 @@ struct DspLle::Impl final {
             return;
         }
         loaded = false;
-        // Send finalization signal via command/reply register 2
-        constexpr u16 FinalizeSignal = 0x8000;
-        while (!teakra.SendDataIsEmpty(2))
-            RunTeakraSlice();
-        teakra.SendData(2, FinalizeSignal);
-        // Wait for completion
-        while (!teakra.RecvDataIsReady(2))
-            RunTeakraSlice();
-        teakra.RecvData(2); // Discard the value
+        {
+            auto lock{LockTeakra()};
+            // Send finalization signal via command/reply register 2
+            constexpr u16 FinalizeSignal = 0x8000;
+            while (!teakra.SendDataIsEmpty(2))
+                RunTeakraSlice();
+            teakra.SendData(2, FinalizeSignal);
+            // Wait for completion
+            while (!teakra.RecvDataIsReady(2))
+                RunTeakraSlice();
+            teakra.RecvData(2); // Discard the value
+        }
         system.CoreTiming().UnscheduleEvent(teakra_slice_event, 0);
         StopTeakraThread();
     }
 };
 
 u16 DspLle::RecvData(u32 register_number) {
+    auto lock{impl->LockTeakra()};
     while (!impl->teakra.RecvDataIsReady(register_number))
         impl->RunTeakraSlice();
     return impl->teakra.RecvData(static_cast<u8>(register_number));
 }
 
 bool DspLle::RecvDataIsReady(u32 register_number) const {
+    auto lock{impl->LockTeakra()};
     return impl->teakra.RecvDataIsReady(register_number);
 }
 
 void DspLle::SetSemaphore(u16 semaphore_value) {
+    auto lock{impl->LockTeakra()};
     impl->teakra.SetSemaphore(semaphore_value);
 }
 
 std::vector<u8> DspLle::PipeRead(DspPipe pipe_number, u32 length) {
+    auto lock{impl->LockTeakra()};
     return impl->ReadPipe(static_cast<u8>(pipe_number), static_cast<u16>(length));
 }
 
 std::size_t DspLle::GetPipeReadableSize(DspPipe pipe_number) const {
+    auto lock{impl->LockTeakra()};
     return impl->GetPipeReadableSize(static_cast<u8>(pipe_number));
 }
 
 void DspLle::PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer) {
+    auto lock{impl->LockTeakra()};
     impl->WritePipe(static_cast<u8>(pipe_number), buffer);
 }
 
@@ -375,23 +501,18 @@ std::array<u8, Memory::DSP_RAM_SIZE>& DspLle::GetDspMemory() {
 }
 
 void DspLle::SetServiceToInterrupt(std::weak_ptr<Service::DSP::DSP_DSP> dsp) {
-    impl->teakra.SetRecvDataHandler(0, [this, dsp]() {
+    impl->dsp_dsp = std::move(dsp);
+    impl->teakra.SetRecvDataHandler(0, [this]() {
         if (!impl->loaded)
             return;
-        std::lock_guard lock{HLE::g_hle_lock};
-        if (auto locked{dsp.lock()})
-            locked->SignalInterrupt(Service::DSP::DSP_DSP::InterruptType::Zero,
-                                    static_cast<DspPipe>(0));
+        impl->SignalInterrupt("DspLle::RecvData0", InterruptType::Zero, static_cast<DspPipe>(0));
     });
-    impl->teakra.SetRecvDataHandler(1, [this, dsp]() {
+    impl->teakra.SetRecvDataHandler(1, [this]() {
         if (!impl->loaded)
             return;
-        std::lock_guard lock{HLE::g_hle_lock};
-        if (auto locked{dsp.lock()})
-            locked->SignalInterrupt(Service::DSP::DSP_DSP::InterruptType::One,
-                                    static_cast<DspPipe>(0));
+        impl->SignalInterrupt("DspLle::RecvData1", InterruptType::One, static_cast<DspPipe>(0));
     });
-    auto ProcessPipeEvent{[this, dsp](bool event_from_data) {
+    auto ProcessPipeEvent{[this](bool event_from_data) {
         if (!impl->loaded)
             return;
         auto& teakra{impl->teakra};
@@ -414,12 +535,9 @@ void DspLle::SetServiceToInterrupt(std::weak_ptr<Service::DSP::DSP_DSP> dsp) {
                 // Pipe 0 is for debug. Console automatically drains this pipe and discards the
                 // data
                 impl->ReadPipe(pipe, impl->GetPipeReadableSize(pipe));
-            else {
-                std::lock_guard lock{HLE::g_hle_lock};
-                if (auto locked{dsp.lock()})
-                    locked->SignalInterrupt(Service::DSP::DSP_DSP::InterruptType::Pipe,
-                                            static_cast<DspPipe>(pipe));
-            }
+            else
+                impl->SignalInterrupt("DspLle::PipeEvent", InterruptType::Pipe,
+                                      static_cast<DspPipe>(pipe));
         }
     }};
     impl->teakra.SetRecvDataHandler(2, [ProcessPipeEvent]() { ProcessPipeEvent(true); });
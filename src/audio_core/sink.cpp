@@ -3,16 +3,60 @@
 // Refer to the license.txt file included.
 
 #include <cstdarg>
+#include <cstdio>
+#include <limits>
 #include <mutex>
 #include <vector>
 #include <cubeb/cubeb.h>
 #include "audio_core/audio_types.h"
 #include "audio_core/sink.h"
 #include "common/logging/log.h"
+#include "common/swap.h"
 
 namespace AudioCore {
 
-struct Sink::Impl {
+namespace {
+
+struct WavHeader {
+    u32_le riff_magic;
+    u32_le riff_size;
+    u32_le wave_magic;
+    u32_le fmt_magic;
+    u32_le fmt_size;
+    u16_le format;
+    u16_le channels;
+    u32_le sample_rate;
+    u32_le byte_rate;
+    u16_le block_align;
+    u16_le bits_per_sample;
+    u32_le data_magic;
+    u32_le data_size;
+};
+static_assert(sizeof(WavHeader) == 44, "WavHeader has incorrect size");
+
+constexpr u32 wav_bytes_per_sample{2 * sizeof(s16)};
+
+WavHeader MakeWavHeader(u32 data_size) {
+    WavHeader header{};
+    header.riff_magic = 0x46464952; // "RIFF"
+    header.riff_size = sizeof(WavHeader) - 8 + data_size;
+    header.wave_magic = 0x45564157; // "WAVE"
+    header.fmt_magic = 0x20746D66;  // "fmt "
+    header.fmt_size = 16;
+    header.format = 1; // PCM
+    header.channels = 2;
+    header.sample_rate = native_sample_rate;
+    header.byte_rate = native_sample_rate * wav_bytes_per_sample;
+    header.block_align = wav_bytes_per_sample;
+    header.bits_per_sample = 16;
+    header.data_magic = 0x61746164; // "data"
+    header.data_size = data_size;
+    return header;
+}
+
+} // Anonymous namespace
+
+struct CubebSink::Impl {
     cubeb* ctx;
     cubeb_stream* stream;
 
@@ -24,7 +68,7 @@ struct Sink::Impl {
     static void LogCallback(char const* fmt, ...);
 };
 
-Sink::Sink(std::string target_device_name) : impl{std::make_unique<Impl>()} {
+CubebSink::CubebSink(std::string target_device_name) : impl{std::make_unique<Impl>()} {
     if (cubeb_init(&impl->ctx, "Citra", nullptr) != CUBEB_OK) {
         LOG_ERROR(Audio, "cubeb_init failed");
         return;
@@ -79,7 +123,7 @@ Sink::Sink(std::string target_device_name) : impl{std::make_unique<Impl>()} {
     }
 }
 
-Sink::~Sink() {
+CubebSink::~CubebSink() {
     if (!impl->ctx)
         return;
     impl->cb = nullptr;
@@ -89,12 +133,12 @@ Sink::~Sink() {
     cubeb_destroy(impl->ctx);
 }
 
-void Sink::SetCallback(std::function<void(s16*, std::size_t)> cb) {
+void CubebSink::SetCallback(std::function<void(s16*, std::size_t)> cb) {
     impl->cb = cb;
 }
 
-long Sink::Impl::DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
-                              void* output_buffer, long num_frames) {
+long CubebSink::Impl::DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
+                                   void* output_buffer, long num_frames) {
     Impl* impl{static_cast<Impl*>(user_data)};
     s16* buffer{reinterpret_cast<s16*>(output_buffer)};
     if (!impl || !impl->cb) {
@@ -106,7 +150,7 @@ long Sink::Impl::DataCallback(cubeb_stream* stream, void* user_data, const void*
     return num_frames;
 }
 
-void Sink::Impl::StateCallback(cubeb_stream* stream, void* user_data, cubeb_state state) {
+void CubebSink::Impl::StateCallback(cubeb_stream* stream, void* user_data, cubeb_state state) {
     switch (state) {
     case CUBEB_STATE_STARTED:
         LOG_INFO(Audio, "Audio Stream Started");
@@ -123,7 +167,7 @@ void Sink::Impl::StateCallback(cubeb_stream* stream, void* user_data, cubeb_stat
     }
 }
 
-void Sink::Impl::LogCallback(char const* format, ...) {
+void CubebSink::Impl::LogCallback(char const* format, ...) {
     std::array<char, 512> buffer;
     std::va_list args;
     va_start(args, format);
@@ -137,6 +181,45 @@ void Sink::Impl::LogCallback(char const* format, ...) {
     LOG_INFO(Audio, "{}", buffer.data());
 }
 
+WavSink::WavSink(const std::string& path) {
+    if (!FileUtil::CreateFullPath(path) || !file.Open(path, "wb") ||
+        file.WriteObject(MakeWavHeader(0)) != 1) {
+        LOG_ERROR(Audio, "Failed to create WAV file {}", path);
+        file.Close();
+        return;
+    }
+    LOG_INFO(Audio, "Writing audio to {}", path);
+}
+
+WavSink::~WavSink() {
+    if (!file.IsOpen())
+        return;
+    // Fill in the sizes now that the length is known
+    if (!file.Seek(0, SEEK_SET) || file.WriteObject(MakeWavHeader(data_size)) != 1)
+        LOG_ERROR(Audio, "Failed to finish WAV file");
+}
+
+void WavSink::PushSamples(const s16* samples, std::size_t sample_count) {
+    if (!file.IsOpen())
+        return;
+    // Stop before the RIFF sizes overflow rather than writing a corrupt file
+    const std::size_t size{sample_count * wav_bytes_per_sample};
+    if (data_size + size > std::numeric_limits<u32>::max() - sizeof(WavHeader))
+        return;
+    data_size += static_cast<u32>(file.WriteArray(samples, sample_count * 2) * sizeof(s16));
+}
+
+std::unique_ptr<Sink> CreateSink(const std::string& device_id) {
+    if (device_id == "null")
+        return std::make_unique<NullSink>();
+    if (device_id == "wav")
+        return std::make_unique<WavSink>(FileUtil::GetUserPath(FileUtil::UserPath::UserDir) +
+                                         "audio.wav");
+    if (device_id.rfind("wav:", 0) == 0)
+        return std::make_unique<WavSink>(device_id.substr(4));
+    return std::make_unique<CubebSink>(device_id);
+}
+
 std::vector<std::string> ListDevices() {
     std::vector<std::string> device_list;
     cubeb* ctx;
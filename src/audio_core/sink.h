@@ -8,27 +8,84 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include "common/common_types.h"
+#include "common/file_util.h"
 
 namespace AudioCore {
 
+/**
+ * Audio output device. Real-time sinks pull samples through the callback as the device consumes
+ * them, while immediate sinks are handed every frame as soon as it's generated.
+ */
 class Sink {
 public:
-    explicit Sink(std::string device_id);
-    ~Sink();
+    virtual ~Sink() = default;
 
     /**
      * Set callback for samples
      * @param samples Samples in interleaved stereo PCM16 format.
      * @param sample_count Number of samples.
      */
-    void SetCallback(std::function<void(s16*, std::size_t)> cb);
+    virtual void SetCallback(std::function<void(s16*, std::size_t)> cb) {}
+
+    /// Returns true if samples are passed with PushSamples instead of being pulled in real time
+    virtual bool IsImmediate() const {
+        return false;
+    }
+
+    /**
+     * Consumes samples right away, only called for immediate sinks
+     * @param samples Samples in interleaved stereo PCM16 format.
+     * @param sample_count Number of samples.
+     */
+    virtual void PushSamples(const s16* samples, std::size_t sample_count) {}
+};
+
+/// Plays audio through cubeb
+class CubebSink final : public Sink {
+public:
+    explicit CubebSink(std::string device_id);
+    ~CubebSink() override;
+
+    void SetCallback(std::function<void(s16*, std::size_t)> cb) override;
 
 private:
     struct Impl;
     std::unique_ptr<Impl> impl;
 };
 
+/// Discards all audio, without any real-time pacing
+class NullSink final : public Sink {
+public:
+    bool IsImmediate() const override {
+        return true;
+    }
+};
+
+/// Streams all audio to a WAV file, without any real-time pacing
+class WavSink final : public Sink {
+public:
+    explicit WavSink(const std::string& path);
+    ~WavSink() override;
+
+    bool IsImmediate() const override {
+        return true;
+    }
+
+    void PushSamples(const s16* samples, std::size_t sample_count) override;
+
+private:
+    FileUtil::IOFile file;
+    u32 data_size{};
+};
+
+/**
+ * Creates the sink for an output device setting. "null" discards the audio, "wav" writes it to
+ * audio.wav in the user folder and "wav:<path>" to the given file. Anything else is a cubeb device.
+ */
+std::unique_ptr<Sink> CreateSink(const std::string& device_id);
+
 std::vector<std::string> ListDevices();
 
 } // namespace AudioCore
@@ -59,4 +59,55 @@ void TimeStretcher::Flush() {
     sound_touch->flush();
 }
 
+constexpr s64 rate_scale_factor{1 << 24};
+
+std::size_t RateController::Update(std::size_t buffered, std::size_t target,
+                                   std::size_t num_out) {
+    if (num_out == 0)
+        return 0;
+    // Relative error of the fill level, positive when playback has to speed up
+    const double error{(static_cast<double>(buffered) - static_cast<double>(target)) /
+                       static_cast<double>(std::max<std::size_t>(target, 1))};
+    const double time_delta{static_cast<double>(num_out) / native_sample_rate}; // seconds
+    // The proportional term reaches the limit when the FIFO is empty or twice the target, the
+    // integral term removes the remaining offset over a few seconds
+    constexpr double kp{max_adjustment};
+    constexpr double ki{max_adjustment / 4.0};
+    integral = std::clamp(integral + error * time_delta, -max_adjustment / ki, max_adjustment / ki);
+    const double adjustment{std::clamp(kp * error + ki * integral, -max_adjustment, max_adjustment)};
+    step = static_cast<s64>((1.0 + adjustment) * rate_scale_factor);
+    // Input frames loaded while producing the output, see Process
+    return static_cast<std::size_t>((position + static_cast<s64>(num_out - 1) * step) /
+                                    rate_scale_factor);
+}
+
+std::size_t RateController::Process(const s16* in, std::size_t num_in, s16* out,
+                                    std::size_t num_out) {
+    std::size_t inputi{};
+    for (std::size_t outputi{}; outputi < num_out; outputi++) {
+        while (position >= rate_scale_factor) {
+            if (inputi == num_in)
+                return outputi;
+            previous = current;
+            current = {in[inputi * 2], in[inputi * 2 + 1]};
+            inputi++;
+            position -= rate_scale_factor;
+        }
+        for (std::size_t channel{}; channel < 2; channel++) {
+            const s64 delta{current[channel] - previous[channel]};
+            out[outputi * 2 + channel] =
+                static_cast<s16>(previous[channel] + delta * position / rate_scale_factor);
+        }
+        position += step;
+    }
+    return num_out;
+}
+
+void RateController::Clear() {
+    previous = {};
+    current = {};
+    position = 0;
+    integral = 0;
+}
+
 } // namespace AudioCore
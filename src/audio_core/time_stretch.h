@@ -36,4 +36,41 @@ private:
     double stretch_ratio{1.0};
 };
 
+/**
+ * Keeps a small output FIFO near its target fill level by playing it back slightly faster or slower
+ * than the native rate, as set by a PI controller. This only makes up for small differences between
+ * the emulation and playback speed, but adds no latency and costs next to nothing.
+ */
+class RateController {
+public:
+    /// Largest deviation from the native playback rate
+    static constexpr double max_adjustment{0.005};
+
+    /**
+     * Picks the playback rate for the next output block.
+     * @param buffered Number of frames in the FIFO
+     * @param target   Desired number of frames in the FIFO
+     * @param num_out  Number of frames that will be output
+     * @returns Number of frames to pop from the FIFO for the block
+     */
+    std::size_t Update(std::size_t buffered, std::size_t target, std::size_t num_out);
+
+    /// @param in       Input sample buffer, as many frames as Update returned or fewer on underrun
+    /// @param num_in   Number of input frames in `in`
+    /// @param out      Output sample buffer
+    /// @param num_out  Desired number of output frames in `out`
+    /// @returns Actual number of frames written to `out`
+    std::size_t Process(const s16* in, std::size_t num_in, s16* out, std::size_t num_out);
+
+    void Clear();
+
+private:
+    std::array<s16, 2> previous{};
+    std::array<s16, 2> current{};
+    /// Position between previous and current, with 24 fractional bits
+    s64 position{};
+    s64 step{};
+    double integral{};
+};
+
 } // namespace AudioCore
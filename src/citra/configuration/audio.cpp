@@ -21,6 +21,8 @@ void ConfigurationAudio::LoadConfiguration() {
     ui->toggle_audio_stretching->setChecked(Settings::values.enable_audio_stretching);
     // Load output devices
     ui->output_device_combo_box->addItem("auto");
+    ui->output_device_combo_box->addItem("null");
+    ui->output_device_combo_box->addItem("wav");
     std::vector<std::string> device_list{AudioCore::ListDevices()};
     for (const auto& device : device_list)
         ui->output_device_combo_box->addItem(device.c_str());
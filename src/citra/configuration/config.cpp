@@ -207,6 +207,7 @@ void Config::Load() {
     Settings::values.bg_green = ReadSetting("bg_green", 0.0).toFloat();
     Settings::values.bg_blue = ReadSetting("bg_blue", 0.0).toFloat();
     Settings::values.enable_cache_clear = ReadSetting("enable_cache_clear", false).toBool();
+    Settings::values.use_page_protection = ReadSetting("use_page_protection", false).toBool();
     settings->endGroup();
     settings->beginGroup("Layout");
     Settings::values.layout_option =
@@ -225,6 +226,11 @@ void Config::Load() {
     settings->beginGroup("Audio");
     Settings::values.enable_audio_stretching =
         ReadSetting("enable_audio_stretching", true).toBool();
+    Settings::values.enable_parallel_audio_sources =
+        ReadSetting("enable_parallel_audio_sources", false).toBool();
+    Settings::values.enable_low_latency_audio =
+        ReadSetting("enable_low_latency_audio", false).toBool();
+    Settings::values.audio_latency = static_cast<u16>(ReadSetting("audio_latency", 30).toInt());
     Settings::values.output_device = ReadSetting("output_device", "auto").toString().toStdString();
     settings->endGroup();
     using namespace Service::CAM;
@@ -249,6 +255,8 @@ void Config::Load() {
     settings->endGroup();
     settings->beginGroup("Data Storage");
     Settings::values.use_virtual_sd = ReadSetting("use_virtual_sd", true).toBool();
+    Settings::values.use_title_cache = ReadSetting("use_title_cache", false).toBool();
+    Settings::values.use_save_write_back = ReadSetting("use_save_write_back", false).toBool();
     Settings::values.nand_dir = ReadSetting("nand_dir", "").toString().toStdString();
     Settings::values.sdmc_dir = ReadSetting("sdmc_dir", "").toString().toStdString();
     settings->endGroup();
@@ -261,6 +269,7 @@ void Config::Load() {
     settings->endGroup();
     settings->beginGroup("Miscellaneous");
     Settings::values.log_filter = ReadSetting("log_filter", "*:Info").toString().toStdString();
+    Settings::values.record_hle_lock_stats = ReadSetting("record_hle_lock_stats", false).toBool();
     settings->endGroup();
     settings->beginGroup("Hacks");
     Settings::values.priority_boost = ReadSetting("priority_boost", false).toBool();
@@ -478,6 +487,7 @@ void Config::Save() {
     WriteSetting("bg_green", static_cast<double>(Settings::values.bg_green), 0.0);
     WriteSetting("bg_blue", static_cast<double>(Settings::values.bg_blue), 0.0);
     WriteSetting("enable_cache_clear", Settings::values.enable_cache_clear, false);
+    WriteSetting("use_page_protection", Settings::values.use_page_protection, false);
     settings->endGroup();
     settings->beginGroup("Layout");
     WriteSetting("layout_option", static_cast<int>(Settings::values.layout_option));
@@ -494,6 +504,10 @@ void Config::Save() {
     settings->endGroup();
     settings->beginGroup("Audio");
     WriteSetting("enable_audio_stretching", Settings::values.enable_audio_stretching, true);
+    WriteSetting("enable_parallel_audio_sources", Settings::values.enable_parallel_audio_sources,
+                 false);
+    WriteSetting("enable_low_latency_audio", Settings::values.enable_low_latency_audio, false);
+    WriteSetting("audio_latency", Settings::values.audio_latency, 30);
     WriteSetting("output_device", QString::fromStdString(Settings::values.output_device), "auto");
     settings->endGroup();
     using namespace Service::CAM;
@@ -516,6 +530,8 @@ void Config::Save() {
     settings->endGroup();
     settings->beginGroup("Data Storage");
     WriteSetting("use_virtual_sd", Settings::values.use_virtual_sd, true);
+    WriteSetting("use_title_cache", Settings::values.use_title_cache, false);
+    WriteSetting("use_save_write_back", Settings::values.use_save_write_back, false);
     WriteSetting("nand_dir", QString::fromStdString(Settings::values.nand_dir));
     WriteSetting("sdmc_dir", QString::fromStdString(Settings::values.sdmc_dir));
     settings->endGroup();
@@ -528,6 +544,7 @@ void Config::Save() {
     settings->endGroup();
     settings->beginGroup("Miscellaneous");
     WriteSetting("log_filter", QString::fromStdString(Settings::values.log_filter), "*:Info");
+    WriteSetting("record_hle_lock_stats", Settings::values.record_hle_lock_stats, false);
     settings->endGroup();
     settings->beginGroup("Hacks");
     WriteSetting("priority_boost", Settings::values.priority_boost, false);
@@ -0,0 +1,128 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <mutex>
+#include "citra/program_list_cache.h"
+#include "common/common_funcs.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+
+namespace {
+
+constexpr u32 PROGRAM_LIST_CACHE_MAGIC{0x4C504943}; // "CIPL"
+constexpr u32 PROGRAM_LIST_CACHE_VERSION{1};
+
+struct CacheHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le entry_count;
+};
+static_assert(sizeof(CacheHeader) == 0x10, "CacheHeader has incorrect size");
+
+struct EntryHeader {
+    u64_le size;
+    s64_le modified;
+    s64_le update_modified;
+    u64_le program_id;
+    u64_le extdata_id;
+    u32_le file_type;
+    u32_le path_size;
+    u32_le smdh_size;
+    INSERT_PADDING_WORDS(1);
+};
+static_assert(sizeof(EntryHeader) == 0x38, "EntryHeader has incorrect size");
+
+// Several workers can be alive at once when the list is refreshed quickly
+std::mutex cache_file_mutex;
+
+std::string GetCachePath() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "program_list.bin";
+}
+
+} // Anonymous namespace
+
+void ProgramListCache::Load() {
+    std::lock_guard lock{cache_file_mutex};
+    entries.clear();
+    FileUtil::IOFile file{GetCachePath(), "rb"};
+    if (!file.IsOpen())
+        return;
+    CacheHeader header;
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != PROGRAM_LIST_CACHE_MAGIC || header.version != PROGRAM_LIST_CACHE_VERSION)
+        return;
+    for (u64 i{}; i < header.entry_count; ++i) {
+        EntryHeader entry_header;
+        if (file.ReadBytes(&entry_header, sizeof(entry_header)) != sizeof(entry_header))
+            break;
+        std::string path(entry_header.path_size, '\0');
+        Entry entry;
+        entry.size = entry_header.size;
+        entry.modified = entry_header.modified;
+        entry.update_modified = entry_header.update_modified;
+        entry.program_id = entry_header.program_id;
+        entry.extdata_id = entry_header.extdata_id;
+        entry.file_type = static_cast<Loader::FileType>(static_cast<u32>(entry_header.file_type));
+        entry.smdh.resize(entry_header.smdh_size);
+        if (file.ReadBytes(path.data(), path.size()) != path.size() ||
+            file.ReadBytes(entry.smdh.data(), entry.smdh.size()) != entry.smdh.size()) {
+            LOG_WARNING(Frontend, "Program list cache is truncated");
+            break;
+        }
+        entries.emplace(std::move(path), std::move(entry));
+    }
+    LOG_DEBUG(Frontend, "Loaded {} program list cache entries", entries.size());
+}
+
+void ProgramListCache::Save() const {
+    std::lock_guard lock{cache_file_mutex};
+    const std::string path{GetCachePath()};
+    const std::string temp_path{path + ".tmp"};
+    if (!FileUtil::CreateFullPath(path))
+        return;
+    {
+        FileUtil::IOFile file{temp_path, "wb"};
+        CacheHeader header{};
+        header.magic = PROGRAM_LIST_CACHE_MAGIC;
+        header.version = PROGRAM_LIST_CACHE_VERSION;
+        header.entry_count = entries.size();
+        bool good{file.WriteObject(header) == 1};
+        for (const auto& [entry_path, entry] : entries) {
+            EntryHeader entry_header{};
+            entry_header.size = entry.size;
+            entry_header.modified = entry.modified;
+            entry_header.update_modified = entry.update_modified;
+            entry_header.program_id = entry.program_id;
+            entry_header.extdata_id = entry.extdata_id;
+            entry_header.file_type = static_cast<u32>(entry.file_type);
+            entry_header.path_size = static_cast<u32>(entry_path.size());
+            entry_header.smdh_size = static_cast<u32>(entry.smdh.size());
+            good = good && file.WriteObject(entry_header) == 1 &&
+                   file.WriteBytes(entry_path.data(), entry_path.size()) == entry_path.size() &&
+                   file.WriteBytes(entry.smdh.data(), entry.smdh.size()) == entry.smdh.size();
+        }
+        if (!good) {
+            LOG_ERROR(Frontend, "Failed to write program list cache {}", temp_path);
+            file.Close();
+            FileUtil::Delete(temp_path);
+            return;
+        }
+    }
+    FileUtil::Delete(path);
+    if (!FileUtil::Rename(temp_path, path))
+        LOG_ERROR(Frontend, "Failed to store program list cache {}", path);
+}
+
+const ProgramListCache::Entry* ProgramListCache::Find(const std::string& path, u64 size,
+                                                      s64 modified) const {
+    auto itr{entries.find(path)};
+    if (itr == entries.end() || itr->second.size != size || itr->second.modified != modified)
+        return nullptr;
+    return &itr->second;
+}
+
+void ProgramListCache::Insert(const std::string& path, Entry entry) {
+    entries.insert_or_assign(path, std::move(entry));
+}
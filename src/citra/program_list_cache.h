@@ -0,0 +1,46 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "core/loader/loader.h"
+
+/**
+ * Persistent index of the metadata of scanned programs. Entries are keyed by the path, size and
+ * modification time of the file, so that only new or changed files have to be parsed again.
+ */
+class ProgramListCache {
+public:
+    struct Entry {
+        u64 size{};
+        s64 modified{};
+        /// Modification time of the content folder of the update title, if there is one
+        s64 update_modified{};
+        u64 program_id{};
+        u64 extdata_id{};
+        Loader::FileType file_type{Loader::FileType::Unknown};
+        std::vector<u8> smdh;
+    };
+
+    /// Reads the index from the cache folder
+    void Load();
+
+    /// Writes the index to the cache folder, replacing the old one
+    void Save() const;
+
+    /**
+     * Looks up the metadata of a file.
+     * @return The entry, or nullptr if the file isn't indexed or has changed since
+     */
+    const Entry* Find(const std::string& path, u64 size, s64 modified) const;
+
+    void Insert(const std::string& path, Entry entry);
+
+private:
+    std::unordered_map<std::string, Entry> entries;
+};
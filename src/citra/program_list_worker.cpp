@@ -2,12 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <memory>
+#include <thread>
+#include <QDateTime>
 #include <QFileInfo>
 #include "citra/program_list.h"
+#include "citra/program_list_cache.h"
 #include "citra/program_list_p.h"
 #include "citra/program_list_worker.h"
 #include "citra/ui_settings.h"
+#include "common/thread_pool.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/loader/loader.h"
@@ -19,6 +24,49 @@ static bool HasSupportedFileExtension(const std::string& file_name) {
     return ProgramList::supported_file_extensions.contains(file.suffix(), Qt::CaseInsensitive);
 }
 
+static s64 GetModificationTime(const QFileInfo& info) {
+    return info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+}
+
+static bool HasUpdate(u64 program_id) {
+    return program_id >= 0x0004000000000000 && program_id <= 0x00040000FFFFFFFF;
+}
+
+/// Returns the modification time of the content folder of the update for a program
+static s64 GetUpdateModificationTime(u64 program_id) {
+    if (!HasUpdate(program_id))
+        return 0;
+    return GetModificationTime(QFileInfo{QString::fromStdString(
+        Service::AM::GetProgramPath(Service::FS::MediaType::SDMC,
+                                    program_id + 0x0000000E00000000) +
+        "content/")});
+}
+
+static ProgramListCache::Entry ParseEntry(Core::System& system, const std::string& path) {
+    ProgramListCache::Entry entry;
+    auto loader{Loader::GetLoader(system, path)};
+    if (!loader)
+        return entry;
+    entry.file_type = loader->GetFileType();
+    loader->ReadProgramID(entry.program_id);
+    loader->ReadExtdataID(entry.extdata_id);
+    entry.update_modified = GetUpdateModificationTime(entry.program_id);
+    loader->ReadIcon(entry.smdh);
+    if (!HasUpdate(entry.program_id))
+        return entry;
+    auto update_path{Service::AM::GetProgramContentPath(Service::FS::MediaType::SDMC,
+                                                        entry.program_id + 0x0000000E00000000)};
+    if (!FileUtil::Exists(update_path))
+        return entry;
+    auto update_loader{Loader::GetLoader(system, update_path)};
+    if (!update_loader)
+        return entry;
+    std::vector<u8> update_smdh;
+    update_loader->ReadIcon(update_smdh);
+    entry.smdh = std::move(update_smdh);
+    return entry;
+}
+
 } // Anonymous namespace
 
 void ProgramListWorker::AddFstEntriesToProgramList(const std::string& dir_path,
@@ -32,43 +80,7 @@ void ProgramListWorker::AddFstEntriesToProgramList(const std::string& dir_path,
         const auto physical_name{fmt::format("{}/{}", directory, virtual_name)};
         const bool is_dir{FileUtil::IsDirectory(physical_name)};
         if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            auto loader{Loader::GetLoader(system, physical_name)};
-            if (!loader)
-                return true;
-            u64 program_id;
-            loader->ReadProgramID(program_id);
-            u64 extdata_id;
-            loader->ReadExtdataID(extdata_id);
-            auto smdh{[this, program_id, &loader]() -> std::vector<u8> {
-                std::vector<u8> original_smdh;
-                loader->ReadIcon(original_smdh);
-                if (program_id < 0x0004000000000000 || program_id > 0x00040000FFFFFFFF)
-                    return original_smdh;
-                auto update_path{Service::AM::GetProgramContentPath(
-                    Service::FS::MediaType::SDMC, program_id + 0x0000000E00000000)};
-                if (!FileUtil::Exists(update_path))
-                    return original_smdh;
-                auto update_loader{Loader::GetLoader(system, update_path)};
-                if (!update_loader)
-                    return original_smdh;
-                std::vector<u8> update_smdh;
-                update_loader->ReadIcon(update_smdh);
-                return update_smdh;
-            }()};
-            if (!Loader::IsValidSMDH(smdh) && UISettings::values.program_list_hide_no_icon)
-                // Skip this invalid entry
-                return true;
-            emit EntryReady(
-                {
-                    new ProgramListItemPath(QString::fromStdString(physical_name), smdh, program_id,
-                                            extdata_id),
-                    new ProgramListItemIssues(program_id),
-                    new ProgramListItemRegion(smdh),
-                    new ProgramListItem(
-                        QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                    new ProgramListItemSize(FileUtil::GetSize(physical_name)),
-                },
-                parent_dir);
+            pending_entries.push_back({physical_name, parent_dir});
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
             AddFstEntriesToProgramList(physical_name, recursion - 1, parent_dir);
@@ -78,6 +90,73 @@ void ProgramListWorker::AddFstEntriesToProgramList(const std::string& dir_path,
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
 }
 
+void ProgramListWorker::ProcessPendingEntries() {
+    ProgramListCache cache;
+    cache.Load();
+    // Entries that were found this time, so that removed files are dropped from the cache
+    ProgramListCache new_cache;
+    std::vector<ProgramListCache::Entry> entries(pending_entries.size());
+    std::vector<std::size_t> misses;
+    for (std::size_t i{}; i < pending_entries.size(); ++i) {
+        const std::string& path{pending_entries[i].path};
+        const QFileInfo info{QString::fromStdString(path)};
+        const u64 size{static_cast<u64>(info.size())};
+        const s64 modified{GetModificationTime(info)};
+        const auto* cached{cache.Find(path, size, modified)};
+        if (cached && cached->update_modified == GetUpdateModificationTime(cached->program_id))
+            entries[i] = *cached;
+        else
+            misses.push_back(i);
+        entries[i].size = size;
+        entries[i].modified = modified;
+    }
+    if (!misses.empty()) {
+        LOG_INFO(Frontend, "Parsing {} of {} programs", misses.size(), pending_entries.size());
+        Common::ThreadPool pool{std::max(std::thread::hardware_concurrency(), 1U)};
+        std::vector<std::future<void>> results;
+        for (const std::size_t i : misses) {
+            results.push_back(pool.Push([this, &entries, i] {
+                if (stop_processing)
+                    return;
+                const u64 size{entries[i].size};
+                const s64 modified{entries[i].modified};
+                entries[i] = ParseEntry(system, pending_entries[i].path);
+                entries[i].size = size;
+                entries[i].modified = modified;
+            }));
+        }
+        for (auto& result : results)
+            result.wait();
+    }
+    if (stop_processing)
+        return;
+    for (std::size_t i{}; i < pending_entries.size(); ++i) {
+        const auto& [path, parent_dir]{pending_entries[i]};
+        const auto& entry{entries[i]};
+        // Failed parses aren't cached, they may succeed once keys or seeds have been added
+        if (entry.file_type == Loader::FileType::Unknown)
+            continue;
+        const bool has_icon{Loader::IsValidSMDH(entry.smdh)};
+        if (has_icon)
+            new_cache.Insert(path, entry);
+        if (!has_icon && UISettings::values.program_list_hide_no_icon)
+            // Skip this invalid entry
+            continue;
+        emit EntryReady(
+            {
+                new ProgramListItemPath(QString::fromStdString(path), entry.smdh,
+                                        entry.program_id, entry.extdata_id),
+                new ProgramListItemIssues(entry.program_id),
+                new ProgramListItemRegion(entry.smdh),
+                new ProgramListItem(
+                    QString::fromStdString(Loader::GetFileTypeString(entry.file_type))),
+                new ProgramListItemSize(entry.size),
+            },
+            parent_dir);
+    }
+    new_cache.Save();
+}
+
 void ProgramListWorker::run() {
     stop_processing = false;
     for (auto& program_dir : program_dirs) {
@@ -124,6 +203,8 @@ void ProgramListWorker::run() {
                                        program_dir.deep_scan ? 256 : 0, program_list_dir);
         }
     }
+    ProcessPendingEntries();
+    pending_entries.clear();
     emit Finished(watch_list);
 }
 
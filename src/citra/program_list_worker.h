@@ -6,6 +6,7 @@
 
 #include <atomic>
 #include <string>
+#include <vector>
 #include <QList>
 #include <QObject>
 #include <QRunnable>
@@ -51,10 +52,19 @@ signals:
     void Finished(QStringList watch_list);
 
 private:
+    struct PendingEntry {
+        std::string path;
+        ProgramListDir* parent_dir;
+    };
+
     void AddFstEntriesToProgramList(const std::string& dir_path, unsigned int recursion,
                                     ProgramListDir* parent_dir);
 
+    /// Emits the entries found while traversing, parsing the files that aren't in the cache
+    void ProcessPendingEntries();
+
     QStringList watch_list;
+    std::vector<PendingEntry> pending_entries;
     QList<UISettings::AppDir>& program_dirs;
     std::atomic_bool stop_processing{};
     Core::System& system;
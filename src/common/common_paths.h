@@ -24,6 +24,7 @@
 #define NAND_DIR "nand"
 #define SYSDATA_DIR "sysdata"
 #define CHEATS_DIR "cheats"
+#define CACHE_DIR "cache"
 #define DLL_DIR "external_dlls"
 
 // Filenames
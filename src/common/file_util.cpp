@@ -244,6 +244,24 @@ bool Rename(const std::string& src_filename, const std::string& dest_filename) {
     return false;
 }
 
+bool Replace(const std::string& src_filename, const std::string& dest_filename) {
+    LOG_TRACE(Common_Filesystem, "{} --> {}", src_filename, dest_filename);
+#ifdef _WIN32
+    // _wrename fails if the destination exists
+    if (MoveFileExW(Common::UTF8ToUTF16W(src_filename).c_str(),
+                    Common::UTF8ToUTF16W(dest_filename).c_str(),
+                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        return true;
+#else
+    // rename replaces the destination atomically
+    if (rename(src_filename.c_str(), dest_filename.c_str()) == 0)
+        return true;
+#endif
+    LOG_ERROR(Common_Filesystem, "failed {} --> {}: {}", src_filename, dest_filename,
+              GetLastErrorMsg());
+    return false;
+}
+
 // Copies file src_filename to dest_filename, returns true on success
 bool Copy(const std::string& src_filename, const std::string& dest_filename) {
     LOG_TRACE(Common_Filesystem, "{} --> {}", src_filename, dest_filename);
@@ -585,6 +603,7 @@ const std::string GetUserPath(UserPath path, const std::string& settings_dir) {
         else
             user_path = GetDataDirectory() + DIR_SEP DATA_DIR DIR_SEP;
 #endif
+        paths.emplace(UserPath::CacheDir, user_path + CACHE_DIR DIR_SEP);
         paths.emplace(UserPath::ConfigDir, user_path + CONFIG_DIR DIR_SEP);
         paths.emplace(UserPath::SDMCDir, user_path + SDMC_DIR DIR_SEP);
         paths.emplace(UserPath::NANDDir, user_path + NAND_DIR DIR_SEP);
@@ -698,6 +717,37 @@ u64 IOFile::GetSize() const {
     return 0;
 }
 
+std::size_t IOFile::ReadAt(void* data, std::size_t length, u64 offset) const {
+    if (!IsOpen())
+        return 0;
+    std::size_t total_read{};
+    while (total_read < length) {
+        u8* const dest{static_cast<u8*>(data) + total_read};
+        const u64 position{offset + total_read};
+#ifdef _WIN32
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(position);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        DWORD read{};
+        const DWORD to_read{static_cast<DWORD>(std::min<std::size_t>(length - total_read,
+                                                                     0x80000000))};
+        if (!ReadFile(reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_file))), dest, to_read,
+                      &read, &overlapped) ||
+            read == 0)
+            break;
+#else
+        const ssize_t read{pread(fileno(m_file), dest, length - total_read,
+                                 static_cast<off_t>(position))};
+        if (read < 0 && errno == EINTR)
+            continue;
+        if (read <= 0)
+            break;
+#endif
+        total_read += static_cast<std::size_t>(read);
+    }
+    return total_read;
+}
+
 bool IOFile::Seek(s64 off, int origin) {
     if (!IsOpen() || 0 != fseeko(m_file, off, origin))
         m_good = false;
@@ -716,6 +766,18 @@ bool IOFile::Flush() {
     return m_good;
 }
 
+bool IOFile::Sync() {
+    if (!Flush() ||
+#ifdef _WIN32
+        _commit(_fileno(m_file))
+#else
+        fsync(fileno(m_file))
+#endif
+            != 0)
+        m_good = false;
+    return m_good;
+}
+
 bool IOFile::Resize(u64 size) {
     if (!IsOpen() ||
 #ifdef _WIN32
@@ -21,6 +21,7 @@ namespace FileUtil {
 
 // User paths for GetUserPath
 enum class UserPath {
+    CacheDir,
     ConfigDir,
     DLLDir,
     NANDDir,
@@ -71,6 +72,10 @@ bool DeleteDir(const std::string& filename);
 // renames file srcFilename to destFilename, returns true on success
 bool Rename(const std::string& srcFilename, const std::string& destFilename);
 
+// renames file srcFilename to destFilename, atomically replacing destFilename if it exists,
+// returns true on success
+bool Replace(const std::string& srcFilename, const std::string& destFilename);
+
 // copies file srcFilename to destFilename, returns true on success
 bool Copy(const std::string& srcFilename, const std::string& destFilename);
 
@@ -227,12 +232,22 @@ public:
         return IsGood();
     }
 
+    /**
+     * Reads from the given position without going through the stream, so it can be called from
+     * several threads at once. Mixing it with buffered reads and writes isn't supported.
+     * @return The amount of bytes read
+     */
+    std::size_t ReadAt(void* data, std::size_t length, u64 offset) const;
+
     bool Seek(s64 off, int origin);
     u64 Tell() const;
     u64 GetSize() const;
     bool Resize(u64 size);
     bool Flush();
 
+    /// Flushes the file and waits until the host OS has written it to the disk
+    bool Sync();
+
     // Clear error state
     void Clear() {
         m_good = true;
@@ -0,0 +1,197 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/host_memory.h"
+#include "common/logging/log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+namespace {
+AccessFaultHandler fault_handler;
+} // Anonymous namespace
+
+#ifdef _WIN32
+
+HostMemory::HostMemory(std::size_t size) : size{size} {
+    const auto size64{static_cast<u64>(size)};
+    mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                 static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64),
+                                 nullptr);
+    if (!mapping) {
+        LOG_ERROR(Common, "CreateFileMapping failed (error {})", GetLastError());
+        return;
+    }
+    host_view = static_cast<u8*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    guest_view = static_cast<u8*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    if (!IsValid())
+        LOG_ERROR(Common, "MapViewOfFile failed (error {})", GetLastError());
+}
+
+HostMemory::~HostMemory() {
+    if (guest_view)
+        UnmapViewOfFile(guest_view);
+    if (host_view)
+        UnmapViewOfFile(host_view);
+    if (mapping)
+        CloseHandle(mapping);
+}
+
+void HostMemory::Protect(std::size_t offset, std::size_t length, MemoryPermission permission) {
+    DWORD protect{};
+    switch (permission) {
+    case MemoryPermission::None:
+        protect = PAGE_NOACCESS;
+        break;
+    case MemoryPermission::Read:
+        protect = PAGE_READONLY;
+        break;
+    case MemoryPermission::ReadWrite:
+        protect = PAGE_READWRITE;
+        break;
+    }
+    DWORD old_protect;
+    if (!VirtualProtect(guest_view + offset, length, protect, &old_protect))
+        LOG_ERROR(Common, "VirtualProtect failed (error {})", GetLastError());
+}
+
+std::size_t GetHostPageSize() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+
+static LONG CALLBACK ExceptionHandler(PEXCEPTION_POINTERS pointers) {
+    const auto& record{*pointers->ExceptionRecord};
+    if (record.ExceptionCode != EXCEPTION_ACCESS_VIOLATION || !fault_handler)
+        return EXCEPTION_CONTINUE_SEARCH;
+    void* fault_address{reinterpret_cast<void*>(record.ExceptionInformation[1])};
+    if (fault_handler(fault_address))
+        return EXCEPTION_CONTINUE_EXECUTION;
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+void SetAccessFaultHandler(AccessFaultHandler handler) {
+    static PVOID handle{};
+    fault_handler = std::move(handler);
+    if (fault_handler && !handle)
+        handle = AddVectoredExceptionHandler(1, ExceptionHandler);
+    else if (!fault_handler && handle) {
+        RemoveVectoredExceptionHandler(handle);
+        handle = nullptr;
+    }
+}
+
+#else
+
+HostMemory::HostMemory(std::size_t size) : size{size} {
+#ifdef __linux__
+    fd = memfd_create("HostMemory", 0);
+#else
+    static std::atomic<u32> counter;
+    const std::string name{"/citra-" + std::to_string(getpid()) + "-" +
+                           std::to_string(counter++)};
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd != -1)
+        shm_unlink(name.c_str());
+#endif
+    if (fd == -1) {
+        LOG_ERROR(Common, "Failed to create shared memory object (errno {})", errno);
+        return;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        LOG_ERROR(Common, "ftruncate failed (errno {})", errno);
+        return;
+    }
+    void* host{mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+    void* guest{mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+    if (host != MAP_FAILED)
+        host_view = static_cast<u8*>(host);
+    if (guest != MAP_FAILED)
+        guest_view = static_cast<u8*>(guest);
+    if (!IsValid())
+        LOG_ERROR(Common, "mmap failed (errno {})", errno);
+}
+
+HostMemory::~HostMemory() {
+    if (guest_view)
+        munmap(guest_view, size);
+    if (host_view)
+        munmap(host_view, size);
+    if (fd != -1)
+        close(fd);
+}
+
+void HostMemory::Protect(std::size_t offset, std::size_t length, MemoryPermission permission) {
+    int prot{PROT_NONE};
+    switch (permission) {
+    case MemoryPermission::None:
+        break;
+    case MemoryPermission::Read:
+        prot = PROT_READ;
+        break;
+    case MemoryPermission::ReadWrite:
+        prot = PROT_READ | PROT_WRITE;
+        break;
+    }
+    if (mprotect(guest_view + offset, length, prot) != 0)
+        LOG_ERROR(Common, "mprotect failed (errno {})", errno);
+}
+
+std::size_t GetHostPageSize() {
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+static struct sigaction old_segv_action;
+static struct sigaction old_bus_action;
+
+static void SignalHandler(int sig, siginfo_t* info, void* context) {
+    if (fault_handler && fault_handler(info->si_addr))
+        return;
+    // Not ours, forward the signal to whoever was installed before us
+    struct sigaction& old_action{sig == SIGSEGV ? old_segv_action : old_bus_action};
+    if (old_action.sa_flags & SA_SIGINFO) {
+        old_action.sa_sigaction(sig, info, context);
+        return;
+    }
+    if (old_action.sa_handler == SIG_DFL || old_action.sa_handler == SIG_IGN) {
+        // Restore the default action, the faulting access will raise the signal again
+        signal(sig, SIG_DFL);
+        return;
+    }
+    old_action.sa_handler(sig);
+}
+
+void SetAccessFaultHandler(AccessFaultHandler handler) {
+    static bool installed{};
+    fault_handler = std::move(handler);
+    if (fault_handler && !installed) {
+        struct sigaction action {};
+        action.sa_sigaction = SignalHandler;
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &old_segv_action);
+        sigaction(SIGBUS, &action, &old_bus_action);
+        installed = true;
+    } else if (!fault_handler && installed) {
+        sigaction(SIGSEGV, &old_segv_action, nullptr);
+        sigaction(SIGBUS, &old_bus_action, nullptr);
+        installed = false;
+    }
+}
+
+#endif
+
+} // namespace Common
@@ -0,0 +1,79 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include "common/common_types.h"
+
+namespace Common {
+
+enum class MemoryPermission {
+    None,
+    Read,
+    ReadWrite,
+};
+
+/**
+ * A block of host memory that is mapped at two different addresses. The guest view can have the
+ * permissions of its pages changed, while the host view always stays readable and writable, so
+ * that emulated hardware can access the backing without triggering access faults.
+ */
+class HostMemory {
+public:
+    explicit HostMemory(std::size_t size);
+    ~HostMemory();
+
+    HostMemory(const HostMemory&) = delete;
+    HostMemory& operator=(const HostMemory&) = delete;
+
+    /// Returns whether both views could be mapped
+    bool IsValid() const {
+        return guest_view && host_view;
+    }
+
+    u8* GuestView() const {
+        return guest_view;
+    }
+
+    u8* HostView() const {
+        return host_view;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+    /**
+     * Changes the permission of pages in the guest view.
+     * @param offset Offset of the first page. Must be aligned to the host page size.
+     * @param length Amount of bytes to change. Must be aligned to the host page size.
+     */
+    void Protect(std::size_t offset, std::size_t length, MemoryPermission permission);
+
+private:
+    u8* guest_view{};
+    u8* host_view{};
+    std::size_t size;
+#ifdef _WIN32
+    void* mapping{};
+#else
+    int fd{-1};
+#endif
+};
+
+/// Returns the page size of the host
+std::size_t GetHostPageSize();
+
+/**
+ * Callback for access violations raised by the host. Returns true if the fault was resolved and
+ * the faulting access should be retried.
+ */
+using AccessFaultHandler = std::function<bool(void* fault_address)>;
+
+/// Installs the process-wide access fault handler. An empty handler uninstalls it.
+void SetAccessFaultHandler(AccessFaultHandler handler);
+
+} // namespace Common
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#pragma once
+
 #include <atomic>
 #include <functional>
 #include <future>
@@ -14,12 +16,12 @@
 namespace Common {
 
 class ThreadPool : NonCopyable {
-private:
+public:
+    /// Creates a separate pool. Push must only ever be called from a single thread per pool.
     explicit ThreadPool(std::size_t num_threads) : num_threads{num_threads}, workers{num_threads} {
         ASSERT(num_threads);
     }
 
-public:
     static ThreadPool& GetPool() {
         static ThreadPool thread_pool{std::thread::hardware_concurrency()};
         return thread_pool;
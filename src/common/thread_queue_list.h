@@ -4,32 +4,34 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <deque>
 #include <boost/range/algorithm_ext/erase.hpp>
+#include "common/bit_set.h"
+#include "common/common_types.h"
 
 namespace Common {
 
+/**
+ * Priority queue of threads. Lower priority values are scheduled first. A bitmap keeps track of
+ * the non-empty priority levels, so finding the best ready thread doesn't depend on the amount
+ * of priority levels or threads.
+ */
 template <class T, unsigned int N>
 struct ThreadQueueList {
-    // TODO: If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
+    static_assert(N <= 64, "The priority bitmap only has room for 64 levels");
 
     typedef unsigned int Priority;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static const Priority NUM_QUEUES{N};
 
-    ThreadQueueList() {
-        first = nullptr;
-    }
-
     // Only for debugging, returns priority level.
     Priority contains(const T& uid) {
         for (Priority i{}; i < NUM_QUEUES; ++i) {
-            Queue& cur{queues[i]};
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
+            const auto& cur{queues[i]};
+            if (std::find(cur.cbegin(), cur.cend(), uid) != cur.cend()) {
                 return i;
             }
         }
@@ -37,124 +39,94 @@ struct ThreadQueueList {
         return -1;
     }
 
-    T get_first() {
-        Queue* cur{first};
-        while (cur) {
-            if (!cur->data.empty())
-                return cur->data.front();
-            cur = cur->next_nonempty;
-        }
-        return T();
+    T get_first() const {
+        if (!non_empty)
+            return T();
+        return queues[first_priority()].front();
     }
 
     T pop_first() {
-        Queue* cur{first};
-        while (cur) {
-            if (!cur->data.empty()) {
-                auto tmp{std::move(cur->data.front())};
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-        return T();
+        if (!non_empty)
+            return T();
+        return pop(first_priority());
     }
 
     T pop_first_better(Priority priority) {
-        Queue* cur{first};
-        Queue* stop{&queues[priority]};
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp{std::move(cur->data.front())};
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+        // Only consider the levels that are strictly better than `priority`
+        const u64 better{non_empty & ((u64{1} << priority) - 1)};
+        if (!better)
+            return T();
+        return pop(static_cast<Priority>(LeastSignificantSetBit(better)));
     }
 
     void push_front(Priority priority, const T& thread_id) {
-        Queue* cur{&queues[priority]};
-        cur->data.push_front(thread_id);
+        queues[priority].push_front(thread_id);
+        non_empty |= u64{1} << priority;
     }
 
     void push_back(Priority priority, const T& thread_id) {
-        Queue* cur{&queues[priority]};
-        cur->data.push_back(thread_id);
+        queues[priority].push_back(thread_id);
+        non_empty |= u64{1} << priority;
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
         remove(old_priority, thread_id);
-        prepare(new_priority);
         push_back(new_priority, thread_id);
     }
 
     void remove(Priority priority, const T& thread_id) {
-        Queue* cur{&queues[priority]};
-        boost::remove_erase(cur->data, thread_id);
+        auto& cur{queues[priority]};
+        boost::remove_erase(cur, thread_id);
+        if (cur.empty())
+            non_empty &= ~(u64{1} << priority);
     }
 
     void rotate(Priority priority) {
-        Queue* cur{&queues[priority]};
+        auto& cur{queues[priority]};
 
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        if (cur.size() > 1) {
+            cur.push_back(std::move(cur.front()));
+            cur.pop_front();
         }
     }
 
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        for (auto& queue : queues)
+            queue.clear();
+        non_empty = 0;
     }
 
     bool empty(Priority priority) const {
-        const Queue* cur{&queues[priority]};
-        return cur->data.empty();
+        return queues[priority].empty();
     }
 
-    void prepare(Priority priority) {
-        Queue* cur{&queues[priority]};
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+    /// Calls `f` for every queued thread, from the best priority to the worst
+    template <typename F>
+    void for_each(F&& f) const {
+        for (u64 levels{non_empty}; levels; levels &= levels - 1)
+            for (const auto& thread : queues[LeastSignificantSetBit(levels)])
+                f(thread);
     }
 
 private:
-    struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty{UnlinkedTag()};
-
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
-    };
-
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
+    Priority first_priority() const {
+        return static_cast<Priority>(LeastSignificantSetBit(non_empty));
     }
 
-    void link(Priority priority) {
-        Queue* cur{&queues[priority]};
-
-        for (int i{static_cast<int>(priority - 1)}; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
-
-        cur->next_nonempty = first;
-        first = cur;
+    T pop(Priority priority) {
+        auto& cur{queues[priority]};
+        auto tmp{std::move(cur.front())};
+        cur.pop_front();
+        if (cur.empty())
+            non_empty &= ~(u64{1} << priority);
+        return tmp;
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
+    // Bit i is set when the queue of priority level i isn't empty
+    u64 non_empty{};
 
     // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
+    std::array<std::deque<T>, NUM_QUEUES> queues;
 };
 
 } // namespace Common
@@ -16,6 +16,7 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/thread.h"
+#include "core/hle/lock.h"
 #include "core/hle/service/cfg/cfg.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/fs_user.h"
@@ -171,6 +172,8 @@ void System::Reschedule() {
 
 System::ResultStatus System::Init(Frontend& frontend, u32 system_mode) {
     m_frontend = &frontend;
+    HLE::g_hle_lock.ResetStats();
+    HLE::g_hle_lock.SetInstrumentationEnabled(Settings::values.record_hle_lock_stats);
     memory = std::make_unique<Memory::MemorySystem>(*this);
     LOG_DEBUG(HW_Memory, "initialized OK");
     timing = std::make_unique<Core::Timing>();
@@ -284,6 +287,8 @@ Frontend& System::GetFrontend() {
 
 void System::Shutdown() {
     // Shutdown emulation session
+    if (HLE::g_hle_lock.IsInstrumentationEnabled())
+        HLE::g_hle_lock.LogStats();
     cpu_core.reset();
     cheat_engine.reset();
     VideoCore::Shutdown();
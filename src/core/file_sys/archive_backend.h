@@ -155,6 +155,9 @@ public:
      */
     virtual u64 GetFreeBytes() const = 0;
 
+    /// Writes back any buffered changes to the files of the archive
+    virtual void Commit() const {}
+
     u64 GetOpenDelayNs() {
         if (delay_generator)
             return delay_generator->GetOpenDelayNs();
@@ -15,6 +15,7 @@
 #include "core/file_sys/path_parser.h"
 #include "core/file_sys/savedata_archive.h"
 #include "core/hle/service/fs/archive.h"
+#include "core/settings.h"
 
 namespace FileSys {
 
@@ -32,6 +33,12 @@ public:
         size = GetSize();
     }
 
+    FixSizeDiskFile(std::shared_ptr<WriteBackBuffer> write_back, const Mode& mode,
+                    std::unique_ptr<DelayGenerator> delay_generator_)
+        : DiskFile{std::move(write_back), mode, std::move(delay_generator_)} {
+        size = GetSize();
+    }
+
     bool SetSize(u64 size) const override {
         return false;
     }
@@ -121,16 +128,20 @@ public:
         case PathParser::FileFound:
             break; // Expected 'success' case
         }
-        FileUtil::IOFile file{full_path, "r+b"};
-        if (!file.IsOpen()) {
-            LOG_ERROR(Service_FS, "Unknown error opening {}", full_path);
-            return ERROR_FILE_NOT_FOUND;
-        }
         Mode rwmode{};
         rwmode.write_flag.Assign(1);
         rwmode.read_flag.Assign(1);
         std::unique_ptr<DelayGenerator> delay_generator{
             std::make_unique<ExtSaveDataDelayGenerator>()};
+        if (Settings::values.use_save_write_back)
+            if (auto write_back{WriteBackBuffer::Open(full_path)})
+                return MakeResult<std::unique_ptr<FileBackend>>(std::make_unique<FixSizeDiskFile>(
+                    std::move(write_back), rwmode, std::move(delay_generator)));
+        FileUtil::IOFile file{full_path, "r+b"};
+        if (!file.IsOpen()) {
+            LOG_ERROR(Service_FS, "Unknown error opening {}", full_path);
+            return ERROR_FILE_NOT_FOUND;
+        }
         auto disk_file{
             std::make_unique<FixSizeDiskFile>(std::move(file), rwmode, std::move(delay_generator))};
         return MakeResult<std::unique_ptr<FileBackend>>(std::move(disk_file));
@@ -3,8 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
 #include <memory>
+#include <thread>
+#include <unordered_map>
 #include "common/common_types.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
@@ -17,6 +21,8 @@ ResultVal<std::size_t> DiskFile::Read(const u64 offset, const std::size_t length
                                       u8* buffer) const {
     if (!mode.read_flag)
         return ERROR_INVALID_OPEN_FLAGS;
+    if (write_back)
+        return MakeResult<std::size_t>(write_back->Read(offset, length, buffer));
     file->Seek(offset, SEEK_SET);
     return MakeResult<std::size_t>(file->ReadBytes(buffer, length));
 }
@@ -25,6 +31,8 @@ ResultVal<std::size_t> DiskFile::Write(const u64 offset, const std::size_t lengt
                                        const u8* buffer) {
     if (!mode.write_flag)
         return ERROR_INVALID_OPEN_FLAGS;
+    if (write_back)
+        return MakeResult<std::size_t>(write_back->Write(offset, length, buffer));
     file->Seek(offset, SEEK_SET);
     std::size_t written{file->WriteBytes(buffer, length)};
     if (flush)
@@ -33,19 +41,237 @@ ResultVal<std::size_t> DiskFile::Write(const u64 offset, const std::size_t lengt
 }
 
 u64 DiskFile::GetSize() const {
+    if (write_back)
+        return write_back->GetSize();
     return file->GetSize();
 }
 
 bool DiskFile::SetSize(const u64 size) const {
+    if (write_back)
+        return write_back->SetSize(size);
     file->Resize(size);
     file->Flush();
     return true;
 }
 
 bool DiskFile::Close() const {
+    if (write_back)
+        return write_back->Commit();
     return file->Close();
 }
 
+namespace {
+std::mutex write_back_registry_mutex;
+std::unordered_map<std::string, std::weak_ptr<WriteBackBuffer>> write_back_registry;
+
+bool IsPathSeparator(char c) {
+    return c == '/' || c == '\\';
+}
+
+/// Returns whether path is the given path or lies inside it, an empty prefix matches every path
+bool IsPathWithin(const std::string& path, const std::string& prefix) {
+    if (path.compare(0, prefix.size(), prefix) != 0)
+        return false;
+    return path.size() == prefix.size() || prefix.empty() || IsPathSeparator(prefix.back()) ||
+           IsPathSeparator(path[prefix.size()]);
+}
+
+/// Returns the live buffers whose host path lies within the prefix, optionally untracking them
+std::vector<std::shared_ptr<WriteBackBuffer>> CollectWriteBackBuffers(const std::string& prefix,
+                                                                      bool erase) {
+    std::vector<std::shared_ptr<WriteBackBuffer>> buffers;
+    std::lock_guard lock{write_back_registry_mutex};
+    for (auto itr{write_back_registry.begin()}; itr != write_back_registry.end();) {
+        if (!IsPathWithin(itr->first, prefix)) {
+            ++itr;
+            continue;
+        }
+        if (auto buffer{itr->second.lock()})
+            buffers.push_back(std::move(buffer));
+        if (erase || itr->second.expired())
+            itr = write_back_registry.erase(itr);
+        else
+            ++itr;
+    }
+    return buffers;
+}
+
+/// Thread that periodically commits buffers that have been dirty for too long
+class WriteBackFlusher {
+public:
+    WriteBackFlusher() : thread{&WriteBackFlusher::Loop, this} {}
+
+    ~WriteBackFlusher() {
+        {
+            std::lock_guard lock{mutex};
+            stop = true;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+
+private:
+    void Loop() {
+        std::unique_lock lock{mutex};
+        while (!cv.wait_for(lock, std::chrono::seconds{1}, [this] { return stop; })) {
+            lock.unlock();
+            for (auto& buffer : CollectWriteBackBuffers({}, false))
+                buffer->CommitIfExpired();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop{};
+    std::thread thread;
+};
+} // Anonymous namespace
+
+std::shared_ptr<WriteBackBuffer> WriteBackBuffer::Open(const std::string& path) {
+    // Started on first use
+    static WriteBackFlusher flusher;
+    std::lock_guard lock{write_back_registry_mutex};
+    auto& entry{write_back_registry[path]};
+    if (auto buffer{entry.lock()})
+        return buffer;
+    if (FileUtil::GetSize(path) > MAX_SIZE) {
+        write_back_registry.erase(path);
+        return nullptr;
+    }
+    std::shared_ptr<WriteBackBuffer> buffer{new WriteBackBuffer{path}};
+    entry = buffer;
+    return buffer;
+}
+
+void WriteBackBuffer::CommitAll(const std::string& prefix) {
+    for (auto& buffer : CollectWriteBackBuffers(prefix, false))
+        buffer->Commit();
+}
+
+void WriteBackBuffer::DetachAll(const std::string& prefix) {
+    for (auto& buffer : CollectWriteBackBuffers(prefix, true)) {
+        std::lock_guard lock{buffer->mutex};
+        buffer->CommitLocked();
+        buffer->detached = true;
+        // The host file is about to be deleted or renamed
+        if (buffer->host_file)
+            buffer->host_file->Close();
+    }
+}
+
+WriteBackBuffer::WriteBackBuffer(std::string path) : path{std::move(path)} {
+    FileUtil::IOFile file{this->path, "rb"};
+    data.resize(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size())
+        LOG_ERROR(Service_FS, "Failed to load {} into its write-back buffer", this->path);
+}
+
+WriteBackBuffer::~WriteBackBuffer() {
+    std::lock_guard lock{mutex};
+    CommitLocked();
+}
+
+std::size_t WriteBackBuffer::Read(u64 offset, std::size_t length, u8* buffer) const {
+    std::lock_guard lock{mutex};
+    if (host_file)
+        return host_file->ReadAt(buffer, length, offset);
+    if (offset >= data.size())
+        return 0;
+    length = std::min<std::size_t>(length, data.size() - offset);
+    std::memcpy(buffer, data.data() + offset, length);
+    return length;
+}
+
+std::size_t WriteBackBuffer::Write(u64 offset, std::size_t length, const u8* buffer) {
+    std::lock_guard lock{mutex};
+    // The offset comes from the guest, don't let it grow the buffer without bounds
+    if (!host_file && (offset > MAX_SIZE || length > MAX_SIZE - offset) &&
+        !SwitchToWriteThrough())
+        return 0;
+    if (host_file) {
+        if (!host_file->Seek(static_cast<s64>(offset), SEEK_SET))
+            return 0;
+        return host_file->WriteBytes(buffer, length);
+    }
+    if (offset + length > data.size())
+        data.resize(offset + length);
+    std::memcpy(data.data() + offset, buffer, length);
+    if (!dirty) {
+        dirty = true;
+        dirty_since = std::chrono::steady_clock::now();
+    }
+    return length;
+}
+
+u64 WriteBackBuffer::GetSize() const {
+    std::lock_guard lock{mutex};
+    return host_file ? host_file->GetSize() : data.size();
+}
+
+bool WriteBackBuffer::SetSize(u64 size) {
+    std::lock_guard lock{mutex};
+    if (!host_file && size > MAX_SIZE && !SwitchToWriteThrough())
+        return false;
+    if (host_file)
+        return host_file->Resize(size);
+    data.resize(size);
+    if (!dirty) {
+        dirty = true;
+        dirty_since = std::chrono::steady_clock::now();
+    }
+    return true;
+}
+
+bool WriteBackBuffer::Commit() {
+    std::lock_guard lock{mutex};
+    return CommitLocked();
+}
+
+void WriteBackBuffer::CommitIfExpired() {
+    std::lock_guard lock{mutex};
+    if (dirty && std::chrono::steady_clock::now() - dirty_since > MAX_DIRTY_TIME)
+        CommitLocked();
+}
+
+bool WriteBackBuffer::CommitLocked() {
+    if (host_file)
+        return !host_file->IsOpen() || host_file->Flush();
+    if (!dirty || detached)
+        return true;
+    // Write a complete new copy next to the file and move it over the old one
+    const std::string temp_path{path + ".tmp"};
+    {
+        FileUtil::IOFile file{temp_path, "wb"};
+        // Sync before the rename, so that a crash can't replace the file with an incomplete copy
+        if (file.WriteBytes(data.data(), data.size()) != data.size() || !file.Sync()) {
+            LOG_ERROR(Service_FS, "Failed to write back {}", path);
+            file.Close();
+            FileUtil::Delete(temp_path);
+            return false;
+        }
+    }
+    if (!FileUtil::Replace(temp_path, path))
+        return false;
+    dirty = false;
+    return true;
+}
+
+bool WriteBackBuffer::SwitchToWriteThrough() {
+    if (detached || !CommitLocked())
+        return false;
+    auto file{std::make_unique<FileUtil::IOFile>(path, "r+b")};
+    if (!file->IsOpen()) {
+        LOG_ERROR(Service_FS, "Failed to open {} for writing through", path);
+        return false;
+    }
+    LOG_INFO(Service_FS, "{} outgrew its write-back buffer, writing through", path);
+    host_file = std::move(file);
+    data.clear();
+    data.shrink_to_fit();
+    return true;
+}
+
 DiskDirectory::DiskDirectory(const std::string& path) {
     u64 size{FileUtil::ScanDirectoryTree(path, directory)};
     directory.size = size;
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "common/common_types.h"
@@ -17,6 +19,63 @@
 
 namespace FileSys {
 
+/**
+ * In-memory copy of a host file that coalesces writes. The contents are written back to the host
+ * when committed, by replacing the file atomically, so a crash never leaves a half-written file.
+ * Every DiskFile opened on the same host path shares the same buffer.
+ */
+class WriteBackBuffer {
+public:
+    /// Files bigger than this are always written through, buffered files that grow past it switch
+    /// to writing through
+    static constexpr u64 MAX_SIZE{32 * 1024 * 1024};
+
+    /// Returns the buffer of the host file at the given path, loading it if it isn't open yet.
+    static std::shared_ptr<WriteBackBuffer> Open(const std::string& path);
+
+    /// Commits every open buffer whose host path is the given path or lies inside it
+    static void CommitAll(const std::string& prefix);
+
+    /**
+     * Commits and then stops tracking every buffer whose host path is the given path or lies
+     * inside it. Used before the host files are deleted or renamed, so that they aren't written
+     * back later.
+     */
+    static void DetachAll(const std::string& prefix);
+
+    ~WriteBackBuffer();
+
+    std::size_t Read(u64 offset, std::size_t length, u8* buffer) const;
+    std::size_t Write(u64 offset, std::size_t length, const u8* buffer);
+    u64 GetSize() const;
+    bool SetSize(u64 size);
+
+    /// Writes the contents back to the host if they changed since the last commit
+    bool Commit();
+
+    /// Commits the contents if they have been dirty for longer than MAX_DIRTY_TIME
+    void CommitIfExpired();
+
+private:
+    explicit WriteBackBuffer(std::string path);
+
+    bool CommitLocked();
+
+    /// Commits the contents and makes every later access go straight to the host file
+    bool SwitchToWriteThrough();
+
+    /// Dirty data is committed by a background thread once it's older than this
+    static constexpr std::chrono::seconds MAX_DIRTY_TIME{5};
+
+    const std::string path;
+    mutable std::mutex mutex;
+    std::vector<u8> data;
+    bool dirty{};
+    bool detached{};
+    std::chrono::steady_clock::time_point dirty_since;
+    std::unique_ptr<FileUtil::IOFile> host_file; ///< Only open once writing through
+};
+
 class DiskFile : public FileBackend {
 public:
     DiskFile(FileUtil::IOFile&& file_, const Mode& mode_,
@@ -26,6 +85,14 @@ public:
         mode.hex = mode_.hex;
     }
 
+    /// Creates a file that reads and writes through a write-back buffer instead of the host file
+    DiskFile(std::shared_ptr<WriteBackBuffer> write_back_, const Mode& mode_,
+             std::unique_ptr<DelayGenerator> delay_generator_)
+        : write_back{std::move(write_back_)} {
+        delay_generator = std::move(delay_generator_);
+        mode.hex = mode_.hex;
+    }
+
     ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override;
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
                                  const u8* buffer) override;
@@ -34,12 +101,15 @@ public:
     bool Close() const override;
 
     void Flush() const override {
-        file->Flush();
+        // Buffered files are only written back on commit, close or once their data gets old
+        if (file)
+            file->Flush();
     }
 
 protected:
     Mode mode;
     std::unique_ptr<FileUtil::IOFile> file;
+    std::shared_ptr<WriteBackBuffer> write_back;
 };
 
 class DiskDirectory : public DirectoryBackend {
@@ -5,14 +5,17 @@
 #include <cinttypes>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include <cryptopp/sha.h>
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/file_sys/ncch_container.h"
 #include "core/file_sys/seed_db.h"
+#include "core/file_sys/title_cache.h"
 #include "core/hw/aes/key.h"
 #include "core/loader/loader.h"
 
@@ -49,10 +52,19 @@ static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decom
     u32 out{decompressed_size};
     u32 index{compressed_size - ((buffer_top_and_bottom >> 24) & 0xFF)};
     u32 stop_index{compressed_size - (buffer_top_and_bottom & 0xFFFFFF)};
-    std::memset(decompressed, 0, decompressed_size);
+    // The compressed data is decoded in place from the end, only the tail needs clearing
     std::memcpy(decompressed, compressed, compressed_size);
+    std::memset(decompressed + compressed_size, 0, decompressed_size - compressed_size);
     while (index > stop_index) {
         u8 control{compressed[--index]};
+        // Fast path for a whole group of literals, which are stored in the same (reversed)
+        // order in both buffers
+        if (control == 0 && index >= stop_index + 8 && out >= 8) {
+            index -= 8;
+            out -= 8;
+            std::memcpy(decompressed + out, compressed + index, 8);
+            continue;
+        }
         for (unsigned i{}; i < 8; i++) {
             if (index <= stop_index)
                 break;
@@ -70,16 +82,20 @@ static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decom
                 u32 segment_size{((segment_offset >> 12) & 15) + 3};
                 segment_offset &= 0x0FFF;
                 segment_offset += 2;
-                // Check if compression is out of bounds
-                if (out < segment_size)
+                // Check if compression is out of bounds. The first byte copied is the highest one
+                // read, so checking it covers the whole segment.
+                if (out < segment_size || out + segment_offset >= decompressed_size)
                     return false;
-                for (unsigned j{}; j < segment_size; j++) {
-                    // Check if compression is out of bounds
-                    if (out + segment_offset >= decompressed_size)
-                        return false;
-                    u8 data{decompressed[out + segment_offset]};
-                    decompressed[--out] = data;
-                }
+                out -= segment_size;
+                u8* dest{decompressed + out};
+                const u8* src{dest + segment_offset + 1};
+                if (segment_offset + 1 >= segment_size)
+                    // The segment doesn't overlap the bytes it's producing, copy it at once
+                    std::memcpy(dest, src, segment_size);
+                else
+                    // Overlapping segments repeat a pattern and must be copied backwards bytewise
+                    for (u32 j{segment_size}; j-- > 0;)
+                        dest[j] = src[j];
             } else {
                 // Check if compression is out of bounds
                 if (out < 1)
@@ -128,7 +144,7 @@ Loader::ResultStatus NCCHContainer::Load() {
         if (Loader::MakeMagic('N', 'C', 'C', 'H') != ncch_header.magic)
             return Loader::ResultStatus::ErrorInvalidFormat;
         has_header = true;
-        bool failed_to_decrypt{};
+        failed_to_decrypt = false;
         if (!ncch_header.no_crypto) {
             is_encrypted = true;
             // Find primary and secondary keys
@@ -160,12 +176,18 @@ Loader::ResultStatus NCCHContainer::Load() {
                         std::memcpy(key_y_secondary.data(), hash.data(), key_y_secondary.size());
                     }
                 }
-                SetKeyY(KeySlotID::NCCHSecure1, key_y_primary);
-                if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure1)) {
-                    LOG_ERROR(Service_FS, "Secure1 KeyX missing");
-                    failed_to_decrypt = true;
-                }
-                primary_key = GetNormalKey(KeySlotID::NCCHSecure1);
+                // The slots are shared with other threads, so the keys are derived without
+                // changing them
+                const auto DeriveKey{[this](std::size_t slot_id, const AESKey& key_y,
+                                            const char* name) {
+                    const auto key{GenerateNormalKey(slot_id, key_y)};
+                    if (!key) {
+                        LOG_ERROR(Service_FS, "{} KeyX missing", name);
+                        failed_to_decrypt = true;
+                    }
+                    return key.value_or(AESKey{});
+                }};
+                primary_key = DeriveKey(KeySlotID::NCCHSecure1, key_y_primary, "Secure1");
                 switch (ncch_header.secondary_key_slot) {
                 case 0:
                     LOG_DEBUG(Service_FS, "Secure1 crypto");
@@ -173,30 +195,15 @@ Loader::ResultStatus NCCHContainer::Load() {
                     break;
                 case 1:
                     LOG_DEBUG(Service_FS, "Secure2 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure2, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure2)) {
-                        LOG_ERROR(Service_FS, "Secure2 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure2);
+                    secondary_key = DeriveKey(KeySlotID::NCCHSecure2, key_y_secondary, "Secure2");
                     break;
                 case 10:
                     LOG_DEBUG(Service_FS, "Secure3 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure3, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure3)) {
-                        LOG_ERROR(Service_FS, "Secure3 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure3);
+                    secondary_key = DeriveKey(KeySlotID::NCCHSecure3, key_y_secondary, "Secure3");
                     break;
                 case 11:
                     LOG_DEBUG(Service_FS, "Secure4 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure4, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure4)) {
-                        LOG_ERROR(Service_FS, "Secure4 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure4);
+                    secondary_key = DeriveKey(KeySlotID::NCCHSecure4, key_y_secondary, "Secure4");
                     break;
                 }
             }
@@ -381,43 +388,55 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
         if (std::strcmp(section.name, name) == 0) {
             LOG_DEBUG(Service_FS, "{} - offset: 0x{:08X}, size: 0x{:08X}, name: {}", section_number,
                       section.offset, section.size, section.name);
-            s64 section_offset{static_cast<s64>(
-                (section.offset + exefs_offset + sizeof(ExeFs_Header) + ncch_offset))};
-            exefs_file.Seek(section_offset, SEEK_SET);
-            std::array<u8, 16> key;
-            if (std::strcmp(section.name, "icon") == 0 || std::strcmp(section.name, "banner") == 0)
-                key = primary_key;
-            else
-                key = secondary_key;
-            CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption dec{key.data(), key.size(),
-                                                              exefs_ctr.data()};
-            dec.Seek(section.offset + sizeof(ExeFs_Header));
-            if (std::strcmp(section.name, ".code") == 0 && is_compressed) {
-                // Section is compressed, read compressed .code section...
-                std::unique_ptr<u8[]> temp_buffer;
-                try {
-                    temp_buffer.reset(new u8[section.size]);
-                } catch (std::bad_alloc&) {
-                    return Loader::ResultStatus::ErrorMemoryAllocationFailed;
+            const bool is_code{std::strcmp(name, ".code") == 0};
+            // Only sections that need decrypting or decompressing are worth caching
+            std::optional<TitleCache> cache;
+            if ((is_encrypted || (is_code && is_compressed)) && !is_tainted &&
+                !failed_to_decrypt && TitleCache::IsEnabled())
+                cache.emplace(ncch_header.program_id, GetContentHash());
+            if (!cache || !cache->Load(name, buffer)) {
+                s64 section_offset{static_cast<s64>(
+                    (section.offset + exefs_offset + sizeof(ExeFs_Header) + ncch_offset))};
+                exefs_file.Seek(section_offset, SEEK_SET);
+                std::array<u8, 16> key;
+                if (std::strcmp(section.name, "icon") == 0 ||
+                    std::strcmp(section.name, "banner") == 0)
+                    key = primary_key;
+                else
+                    key = secondary_key;
+                CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption dec{key.data(), key.size(),
+                                                                  exefs_ctr.data()};
+                dec.Seek(section.offset + sizeof(ExeFs_Header));
+                if (is_code && is_compressed) {
+                    // Section is compressed, read compressed .code section...
+                    std::unique_ptr<u8[]> temp_buffer;
+                    try {
+                        temp_buffer.reset(new u8[section.size]);
+                    } catch (std::bad_alloc&) {
+                        return Loader::ResultStatus::ErrorMemoryAllocationFailed;
+                    }
+                    if (exefs_file.ReadBytes(&temp_buffer[0], section.size) != section.size)
+                        return Loader::ResultStatus::Error;
+                    if (is_encrypted)
+                        dec.ProcessData(&temp_buffer[0], &temp_buffer[0], section.size);
+                    // Decompress .code section...
+                    u32 decompressed_size{LZSS_GetDecompressedSize(&temp_buffer[0], section.size)};
+                    buffer.resize(decompressed_size);
+                    if (!LZSS_Decompress(&temp_buffer[0], section.size, &buffer[0],
+                                         decompressed_size))
+                        return Loader::ResultStatus::ErrorInvalidFormat;
+                } else {
+                    // Section is uncompressed...
+                    buffer.resize(section.size);
+                    if (exefs_file.ReadBytes(&buffer[0], section.size) != section.size)
+                        return Loader::ResultStatus::Error;
+                    if (is_encrypted)
+                        dec.ProcessData(&buffer[0], &buffer[0], section.size);
                 }
-                if (exefs_file.ReadBytes(&temp_buffer[0], section.size) != section.size)
-                    return Loader::ResultStatus::Error;
-                if (is_encrypted)
-                    dec.ProcessData(&temp_buffer[0], &temp_buffer[0], section.size);
-                // Decompress .code section...
-                u32 decompressed_size{LZSS_GetDecompressedSize(&temp_buffer[0], section.size)};
-                buffer.resize(decompressed_size);
-                if (!LZSS_Decompress(&temp_buffer[0], section.size, &buffer[0], decompressed_size))
-                    return Loader::ResultStatus::ErrorInvalidFormat;
-            } else {
-                // Section is uncompressed...
-                buffer.resize(section.size);
-                if (exefs_file.ReadBytes(&buffer[0], section.size) != section.size)
-                    return Loader::ResultStatus::Error;
-                if (is_encrypted)
-                    dec.ProcessData(&buffer[0], &buffer[0], section.size);
+                if (cache)
+                    cache->Store(name, buffer);
             }
-            if (std::strcmp(name, ".code") == 0) {
+            if (is_code) {
                 std::string override_ips{filepath + ".exefsdir/code.ips"};
                 FileUtil::IOFile ips_file{override_ips, "rb"};
                 if (ips_file) {
@@ -467,6 +486,21 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
     return Loader::ResultStatus::ErrorNotUsed;
 }
 
+u64 NCCHContainer::GetContentHash() const {
+    // The keys are included, so that sections decrypted before the right keys or seed were
+    // available aren't used once they are
+    std::array<u8, sizeof(NCCH_Header) + sizeof(ExeFs_Header) + 2 * sizeof(primary_key)> data;
+    u8* out{data.data()};
+    std::memcpy(out, &ncch_header, sizeof(NCCH_Header));
+    out += sizeof(NCCH_Header);
+    std::memcpy(out, &exefs_header, sizeof(ExeFs_Header));
+    out += sizeof(ExeFs_Header);
+    std::memcpy(out, primary_key.data(), primary_key.size());
+    out += primary_key.size();
+    std::memcpy(out, secondary_key.data(), secondary_key.size());
+    return Common::ComputeHash64(data.data(), data.size());
+}
+
 Loader::ResultStatus NCCHContainer::LoadOverrideExeFSSection(const char* name,
                                                              std::vector<u8>& buffer) {
     std::string override_name;
@@ -272,6 +272,9 @@ public:
     ExHeader_Header exheader_header;
 
 private:
+    /// Returns a hash identifying the contents and keys of the NCCH, used to key the title cache
+    u64 GetContentHash() const;
+
     bool has_header{};
     bool has_exheader{};
     bool has_exefs{};
@@ -281,6 +284,7 @@ private:
     bool is_loaded{};
     bool is_compressed{};
     bool is_encrypted{};
+    bool failed_to_decrypt{}; // Is a key or seed needed for decryption missing?
 
     // for decrypting exheader, exefs header and icon/banner section
     std::array<u8, 16> primary_key{};
@@ -1,22 +1,89 @@
 #include <algorithm>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include "common/logging/log.h"
 #include "core/file_sys/romfs_reader.h"
 
 namespace FileSys {
 
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
+    : file{std::move(file)}, file_offset{file_offset}, data_size{data_size} {}
+
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
+                         const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
+                         std::size_t crypto_offset)
+    : is_encrypted{true}, file{std::move(file)}, key{key}, ctr{ctr}, file_offset{file_offset},
+      crypto_offset{crypto_offset}, data_size{data_size} {}
+
+RomFSReader::~RomFSReader() {
+    const auto stats{GetCacheStats()};
+    if (stats.hits + stats.misses != 0)
+        LOG_DEBUG(Service_FS, "RomFS chunk cache: {} hits, {} misses", stats.hits, stats.misses);
+}
+
 std::size_t RomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
-    if (length == 0)
+    if (length == 0 || offset >= data_size)
         return 0; // Crypto++ doesn't like zero size buffer
-    file.Seek(file_offset + offset, SEEK_SET);
-    std::size_t read_length{std::min(length, data_size - offset)};
-    read_length = file.ReadBytes(buffer, read_length);
-    if (is_encrypted) {
-        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d{key.data(), key.size(), ctr.data()};
-        d.Seek(crypto_offset + offset);
-        d.ProcessData(buffer, buffer, read_length);
+    const std::size_t read_length{std::min(length, data_size - offset)};
+    if (!is_encrypted)
+        return file.ReadAt(buffer, read_length, file_offset + offset);
+    // Large reads wouldn't benefit from the cache and would only evict the useful chunks
+    if (read_length >= CHUNK_SIZE)
+        return ReadDecrypted(offset, read_length, buffer);
+    std::size_t copied{};
+    while (copied < read_length) {
+        const std::size_t position{offset + copied};
+        const auto chunk{GetChunk(position / CHUNK_SIZE)};
+        const std::size_t chunk_offset{position % CHUNK_SIZE};
+        if (chunk->size() <= chunk_offset)
+            break;
+        const std::size_t copy_length{std::min(read_length - copied, chunk->size() - chunk_offset)};
+        std::memcpy(buffer + copied, chunk->data() + chunk_offset, copy_length);
+        copied += copy_length;
     }
+    return copied;
+}
+
+std::size_t RomFSReader::ReadDecrypted(std::size_t offset, std::size_t length, u8* buffer) const {
+    const std::size_t read_length{file.ReadAt(buffer, length, file_offset + offset)};
+    if (read_length == 0)
+        return 0;
+    // Crypto++ block ciphers keep scratch space in the object, so reads on different threads can't
+    // share one. Expanding the key is cheap next to reading a chunk from the disk.
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d{key.data(), key.size(), ctr.data()};
+    d.Seek(crypto_offset + offset);
+    d.ProcessData(buffer, buffer, read_length);
     return read_length;
 }
 
+RomFSReader::Chunk RomFSReader::GetChunk(std::size_t index) {
+    {
+        std::lock_guard lock{cache_mutex};
+        auto itr{cache_map.find(index)};
+        if (itr != cache_map.end()) {
+            cache_hits.fetch_add(1, std::memory_order_relaxed);
+            cache.splice(cache.begin(), cache, itr->second);
+            return itr->second->second;
+        }
+    }
+    cache_misses.fetch_add(1, std::memory_order_relaxed);
+    // Read outside of the lock, so that other threads can keep hitting the cache
+    const std::size_t chunk_offset{index * CHUNK_SIZE};
+    std::vector<u8> data(std::min(CHUNK_SIZE, data_size - chunk_offset));
+    data.resize(ReadDecrypted(chunk_offset, data.size(), data.data()));
+    Chunk chunk{std::make_shared<const std::vector<u8>>(std::move(data))};
+    std::lock_guard lock{cache_mutex};
+    if (cache_map.count(index))
+        // Another thread read the same chunk in the meantime
+        return chunk;
+    cache.emplace_front(index, chunk);
+    cache_map.emplace(index, cache.begin());
+    if (cache.size() > MAX_CACHED_CHUNKS) {
+        cache_map.erase(cache.back().first);
+        cache.pop_back();
+    }
+    return chunk;
+}
+
 } // namespace FileSys
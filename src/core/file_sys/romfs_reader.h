@@ -1,21 +1,34 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "common/file_util.h"
 
 namespace FileSys {
 
+/**
+ * Reads the RomFS of a title from the host file. Reads are positional, so the reader can be used
+ * from several threads at once. Small reads of encrypted RomFS are served from a cache of
+ * decrypted chunks, since games tend to read the same metadata many times.
+ */
 class RomFSReader {
 public:
-    RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : file{std::move(file)}, file_offset{file_offset}, data_size{data_size} {}
-
+    RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
     RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                 const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                std::size_t crypto_offset)
-        : is_encrypted{true}, file{std::move(file)}, key{key}, ctr{ctr}, file_offset{file_offset},
-          crypto_offset{crypto_offset}, data_size{data_size} {}
+                std::size_t crypto_offset);
+    ~RomFSReader();
+
+    struct CacheStats {
+        u64 hits;
+        u64 misses;
+    };
 
     std::size_t GetSize() const {
         return data_size;
@@ -23,7 +36,24 @@ public:
 
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer);
 
+    /// Returns how many chunk lookups hit and missed the decrypted chunk cache
+    CacheStats GetCacheStats() const {
+        return {cache_hits.load(std::memory_order_relaxed),
+                cache_misses.load(std::memory_order_relaxed)};
+    }
+
 private:
+    static constexpr std::size_t CHUNK_SIZE{0x10000};
+    static constexpr std::size_t MAX_CACHED_CHUNKS{32};
+
+    using Chunk = std::shared_ptr<const std::vector<u8>>;
+
+    /// Reads and decrypts the given range of the RomFS straight into the buffer
+    std::size_t ReadDecrypted(std::size_t offset, std::size_t length, u8* buffer) const;
+
+    /// Returns the decrypted chunk with the given index, reading it on a cache miss
+    Chunk GetChunk(std::size_t index);
+
     bool is_encrypted{};
     FileUtil::IOFile file;
     std::array<u8, 16> key{};
@@ -31,6 +61,13 @@ private:
     std::size_t file_offset{};
     std::size_t crypto_offset{};
     std::size_t data_size{};
+
+    // Most recently used chunks come first
+    std::mutex cache_mutex;
+    std::list<std::pair<std::size_t, Chunk>> cache;
+    std::unordered_map<std::size_t, decltype(cache)::iterator> cache_map;
+    std::atomic<u64> cache_hits{};
+    std::atomic<u64> cache_misses{};
 };
 
 } // namespace FileSys
@@ -7,6 +7,7 @@
 #include "core/file_sys/errors.h"
 #include "core/file_sys/path_parser.h"
 #include "core/file_sys/savedata_archive.h"
+#include "core/settings.h"
 
 namespace FileSys {
 
@@ -69,12 +70,16 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::_OpenFile(const Path& p
     case PathParser::FileFound:
         break; // Expected 'success' case
     }
+    std::unique_ptr<DelayGenerator> delay_generator{std::make_unique<SaveDataDelayGenerator>()};
+    if (Settings::values.use_save_write_back)
+        if (auto write_back{WriteBackBuffer::Open(full_path)})
+            return MakeResult<std::unique_ptr<FileBackend>>(std::make_unique<DiskFile>(
+                std::move(write_back), mode, std::move(delay_generator)));
     FileUtil::IOFile file{full_path, mode.write_flag ? "r+b" : "rb"};
     if (!file.IsOpen()) {
         LOG_ERROR(Service_FS, "Unknown error opening {}", full_path);
         return ERROR_FILE_NOT_FOUND;
     }
-    std::unique_ptr<DelayGenerator> delay_generator{std::make_unique<SaveDataDelayGenerator>()};
     auto disk_file{std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator))};
     return MakeResult<std::unique_ptr<FileBackend>>(std::move(disk_file));
 }
@@ -101,6 +106,7 @@ ResultCode SaveDataArchive::_DeleteFile(const Path& path) const {
     case PathParser::FileFound:
         break; // Expected 'success' case
     }
+    WriteBackBuffer::DetachAll(full_path);
     if (FileUtil::Delete(full_path))
         return RESULT_SUCCESS;
     LOG_ERROR(Service_FS, "Unknown error deleting {}", full_path);
@@ -121,6 +127,8 @@ ResultCode SaveDataArchive::_RenameFile(const Path& src_path, const Path& dest_p
     }
     const auto src_path_full{path_parser_src.BuildHostPath(mount_point)};
     const auto dest_path_full{path_parser_dest.BuildHostPath(mount_point)};
+    WriteBackBuffer::DetachAll(src_path_full);
+    WriteBackBuffer::DetachAll(dest_path_full);
     if (FileUtil::Rename(src_path_full, dest_path_full))
         return RESULT_SUCCESS;
     // TODO: This code probably isn't right, it'll return a Status even if the file didn't
@@ -155,6 +163,7 @@ static ResultCode _DeleteDirectoryHelper(const Path& path, const std::string& mo
     case PathParser::DirectoryFound:
         break; // Expected 'success' case
     }
+    WriteBackBuffer::DetachAll(full_path);
     if (deleter(full_path))
         return RESULT_SUCCESS;
     LOG_ERROR(Service_FS, "Directory not empty {}", full_path);
@@ -254,6 +263,8 @@ ResultCode SaveDataArchive::_RenameDirectory(const Path& src_path, const Path& d
     }
     const auto src_path_full{path_parser_src.BuildHostPath(mount_point)};
     const auto dest_path_full{path_parser_dest.BuildHostPath(mount_point)};
+    WriteBackBuffer::DetachAll(src_path_full);
+    WriteBackBuffer::DetachAll(dest_path_full);
     if (FileUtil::Rename(src_path_full, dest_path_full))
         return RESULT_SUCCESS;
     // TODO: This code probably isn't right, it'll return a Status even if the file didn't
@@ -294,4 +305,8 @@ u64 SaveDataArchive::GetFreeBytes() const {
     return 1024 * 1024 * 1024;
 }
 
+void SaveDataArchive::Commit() const {
+    WriteBackBuffer::CommitAll(mount_point);
+}
+
 } // namespace FileSys
@@ -33,6 +33,7 @@ public:
     ResultVal<std::unique_ptr<DirectoryBackend>> _OpenDirectory(const Path& path) const override;
 
     u64 GetFreeBytes() const override;
+    void Commit() const override;
 
 protected:
     std::string mount_point;
@@ -0,0 +1,97 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <functional>
+#include <thread>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/file_sys/title_cache.h"
+#include "core/settings.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr u32 TITLE_CACHE_MAGIC{0x43544943}; // "CITC"
+constexpr u32 TITLE_CACHE_VERSION{1};
+
+struct SectionHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le size;
+};
+static_assert(sizeof(SectionHeader) == 0x10, "SectionHeader has incorrect size");
+
+} // Anonymous namespace
+
+TitleCache::TitleCache(u64 program_id, u64 content_hash)
+    : directory{fmt::format("{}titles" DIR_SEP "{:016X}-{:016X}" DIR_SEP,
+                            FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), program_id,
+                            content_hash)} {}
+
+bool TitleCache::IsEnabled() {
+    return Settings::values.use_title_cache;
+}
+
+bool TitleCache::Load(const char* name, std::vector<u8>& buffer) const {
+    FileUtil::IOFile file{GetSectionPath(name), "rb"};
+    if (!file.IsOpen())
+        return false;
+    SectionHeader header;
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != TITLE_CACHE_MAGIC || header.version != TITLE_CACHE_VERSION ||
+        file.GetSize() != sizeof(header) + header.size) {
+        LOG_WARNING(Service_FS, "Ignoring invalid title cache entry {}", GetSectionPath(name));
+        return false;
+    }
+    buffer.resize(header.size);
+    if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size())
+        return false;
+    LOG_DEBUG(Service_FS, "Loaded {} from the title cache", name);
+    return true;
+}
+
+void TitleCache::Store(const char* name, const std::vector<u8>& buffer) const {
+    if (!FileUtil::CreateFullPath(directory)) {
+        LOG_ERROR(Service_FS, "Failed to create title cache directory {}", directory);
+        return;
+    }
+    // Write to a temporary file first, so that an interrupted write never leaves a truncated
+    // entry behind. The program list and the emulation can store the same title at once, so
+    // every thread uses its own temporary file.
+    const std::string path{GetSectionPath(name)};
+    const std::string temp_path{
+        fmt::format("{}.{:x}.tmp", path, std::hash<std::thread::id>{}(std::this_thread::get_id()))};
+    {
+        FileUtil::IOFile file{temp_path, "wb"};
+        SectionHeader header{};
+        header.magic = TITLE_CACHE_MAGIC;
+        header.version = TITLE_CACHE_VERSION;
+        header.size = buffer.size();
+        if (file.WriteObject(header) != 1 ||
+            file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
+            LOG_ERROR(Service_FS, "Failed to write title cache entry {}", temp_path);
+            file.Close();
+            FileUtil::Delete(temp_path);
+            return;
+        }
+    }
+    if (!FileUtil::Replace(temp_path, path)) {
+        LOG_ERROR(Service_FS, "Failed to store title cache entry {}", path);
+        FileUtil::Delete(temp_path);
+    }
+}
+
+std::string TitleCache::GetSectionPath(const char* name) const {
+    // Section names like ".code" would make hidden files
+    std::string file_name{name};
+    if (!file_name.empty() && file_name.front() == '.')
+        file_name.erase(0, 1);
+    return directory + file_name + ".bin";
+}
+
+} // namespace FileSys
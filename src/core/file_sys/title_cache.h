@@ -0,0 +1,41 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace FileSys {
+
+/**
+ * On-disk cache of decrypted and decompressed ExeFS sections of a title, so that later boots
+ * can skip the AES and LZSS work. Entries are keyed by the program ID and a hash of the NCCH and
+ * ExeFS headers, the latter containing the SHA-256 of every section, so a changed image never
+ * hits a stale entry.
+ */
+class TitleCache {
+public:
+    TitleCache(u64 program_id, u64 content_hash);
+
+    /// Returns whether the cache is enabled in the settings
+    static bool IsEnabled();
+
+    /**
+     * Reads a cached section.
+     * @return Whether the section was cached
+     */
+    bool Load(const char* name, std::vector<u8>& buffer) const;
+
+    /// Stores a section, replacing any cached copy
+    void Store(const char* name, const std::vector<u8>& buffer) const;
+
+private:
+    std::string GetSectionPath(const char* name) const;
+
+    std::string directory;
+};
+
+} // namespace FileSys
@@ -94,6 +94,7 @@ public:
     void PushMoveObjects(Kernel::SharedPtr<O>... pointers);
 
     void PushStaticBuffer(const std::vector<u8>& buffer, u8 buffer_id);
+    void PushStaticBuffer(std::vector<u8>&& buffer, u8 buffer_id);
 
     /// Pushes an HLE MappedBuffer interface back to unmapped the buffer.
     void PushMappedBuffer(const Kernel::MappedBuffer& mapped_buffer);
@@ -189,6 +190,16 @@ inline void ResponseBuilder::PushStaticBuffer(const std::vector<u8>& buffer, u8
     context->AddStaticBuffer(buffer_id, buffer);
 }
 
+inline void ResponseBuilder::PushStaticBuffer(std::vector<u8>&& buffer, u8 buffer_id) {
+    ASSERT_MSG(buffer_id < MAX_STATIC_BUFFERS, "Invalid static buffer id");
+
+    Push(StaticBufferDesc(buffer.size(), buffer_id));
+    // This address will be replaced by the correct static buffer address during IPC translation.
+    Push<VAddr>(0xDEADC0DE);
+
+    context->AddStaticBuffer(buffer_id, std::move(buffer));
+}
+
 inline void ResponseBuilder::PushMappedBuffer(const Kernel::MappedBuffer& mapped_buffer) {
     Push(mapped_buffer.GenerateDescriptor());
     Push(mapped_buffer.GetId());
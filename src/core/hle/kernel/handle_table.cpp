@@ -18,9 +18,19 @@ HandleTable::HandleTable(KernelSystem& kernel) : kernel{kernel} {
 
 HandleTable::~HandleTable() = default;
 
-Handle HandleTable::Create(SharedPtr<Object> obj) {
+ResultVal<Handle> HandleTable::Create(SharedPtr<Object> obj) {
     DEBUG_ASSERT(obj);
-    return objects.emplace(++handle_counter, std::move(obj)).first->first;
+    const u16 slot{next_free_slot};
+    if (slot >= MAX_COUNT) {
+        LOG_ERROR(Kernel, "Unable to allocate handle, too many handles in use");
+        return ERR_OUT_OF_HANDLES;
+    }
+    next_free_slot = generations[slot];
+    const u16 generation{next_generation};
+    next_generation = next_generation == MAX_GENERATION ? 1 : next_generation + 1;
+    generations[slot] = generation;
+    objects[slot] = std::move(obj);
+    return MakeResult<Handle>(static_cast<Handle>(generation) << SLOT_BITS | slot);
 }
 
 ResultVal<Handle> HandleTable::Duplicate(Handle handle) {
@@ -29,27 +39,45 @@ ResultVal<Handle> HandleTable::Duplicate(Handle handle) {
         LOG_ERROR(Kernel, "Tried to duplicate invalid handle {:08X}", handle);
         return ERR_INVALID_HANDLE;
     }
-    return MakeResult<Handle>(Create(std::move(object)));
+    return Create(std::move(object));
 }
 
 ResultCode HandleTable::Close(Handle handle) {
-    if (objects.find(handle) == objects.end())
+    const auto slot{FindSlot(handle)};
+    if (!slot)
         return ERR_INVALID_HANDLE;
-    objects.erase(handle);
+    objects[*slot] = nullptr;
+    generations[*slot] = next_free_slot;
+    next_free_slot = *slot;
     return RESULT_SUCCESS;
 }
 
+std::optional<u16> HandleTable::FindSlot(Handle handle) const {
+    const u32 generation{GetGeneration(handle)};
+    if (generation == 0 || generation > MAX_GENERATION)
+        return {};
+    const u16 slot{GetSlot(handle)};
+    if (!objects[slot] || generations[slot] != generation)
+        return {};
+    return slot;
+}
+
 SharedPtr<Object> HandleTable::GetGeneric(Handle handle) const {
     if (handle == CurrentThread)
         return kernel.GetThreadManager().GetCurrentThread();
     else if (handle == CurrentProcess)
         return kernel.GetCurrentProcess();
-    auto itr{objects.find(handle)};
-    return itr == objects.end() ? nullptr : itr->second;
+    const auto slot{FindSlot(handle)};
+    return slot ? objects[*slot] : nullptr;
 }
 
 void HandleTable::Clear() {
-    objects.clear();
+    for (u16 i{}; i < MAX_COUNT; ++i) {
+        generations[i] = i + 1;
+        objects[i] = nullptr;
+    }
+    next_generation = 1;
+    next_free_slot = 0;
 }
 
 } // namespace Kernel
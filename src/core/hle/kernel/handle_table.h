@@ -4,9 +4,9 @@
 
 #pragma once
 
-#include <atomic>
+#include <array>
 #include <cstddef>
-#include <map>
+#include <optional>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/result.h"
@@ -22,22 +22,31 @@ enum KernelHandle : Handle {
  * This class allows the creation of Handles, which are references to objects that can be tested
  * for validity and looked up. Here they are used to pass references to kernel objects to/from the
  * emulated process.
+ *
+ * Handles are indices into a fixed-size slot array stored in the low bits, with a generation
+ * number in the upper bits. The generation of a slot changes every time it's reused, so stale
+ * handles to a closed object don't resolve to the object that took its slot.
  */
 class HandleTable final : NonCopyable {
 public:
+    /// This is the maximum limit of handles allowed per process in CTR-OS.
+    static constexpr std::size_t MAX_COUNT{4096};
+
     explicit HandleTable(KernelSystem& kernel);
     ~HandleTable();
 
     /**
      * Allocates a handle for the given object.
-     * @return The created Handle
+     * @return The created Handle or one of the following errors:
+     * - `ERR_OUT_OF_HANDLES`: the table is full.
      */
-    Handle Create(SharedPtr<Object> obj);
+    ResultVal<Handle> Create(SharedPtr<Object> obj);
 
     /**
      * Returns a new handle that points to the same object as the passed in handle.
      * @return The duplicated Handle or one of the following errors:
      * - `ERR_INVALID_HANDLE`: an invalid handle was passed in.
+     * - `ERR_OUT_OF_HANDLES`: the table is full.
      */
     ResultVal<Handle> Duplicate(Handle handle);
 
@@ -68,8 +77,37 @@ public:
     void Clear();
 
 private:
-    std::map<Handle, SharedPtr<Object>> objects{};
-    std::atomic<u32> handle_counter{};
+    static constexpr u32 SLOT_BITS{12};
+    static constexpr u32 SLOT_MASK{MAX_COUNT - 1};
+    static constexpr u16 MAX_GENERATION{0x7FFF};
+
+    static_assert(MAX_COUNT == 1 << SLOT_BITS);
+
+    static constexpr u16 GetSlot(Handle handle) {
+        return static_cast<u16>(handle & SLOT_MASK);
+    }
+
+    static constexpr u32 GetGeneration(Handle handle) {
+        return handle >> SLOT_BITS;
+    }
+
+    /// Returns the slot of the handle if it refers to a live object.
+    std::optional<u16> FindSlot(Handle handle) const;
+
+    /// Stores the object held by each slot, null if the slot is free.
+    std::array<SharedPtr<Object>, MAX_COUNT> objects;
+
+    /**
+     * The generation of the handle currently held by each slot. For free slots, this holds the
+     * index of the next free slot instead, forming a linked list.
+     */
+    std::array<u16, MAX_COUNT> generations;
+
+    /// Generation given to the next created handle. Never 0, so that no valid handle is 0.
+    u16 next_generation;
+
+    /// Head of the free slot list. MAX_COUNT if the table is full.
+    u16 next_free_slot;
 
     KernelSystem& kernel;
 };
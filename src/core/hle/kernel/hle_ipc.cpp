@@ -72,6 +72,15 @@ HLERequestContext::HLERequestContext(SharedPtr<ServerSession> session)
 
 HLERequestContext::~HLERequestContext() = default;
 
+void HLERequestContext::Reset(SharedPtr<ServerSession> session) {
+    this->session = std::move(session);
+    cmd_buf[0] = 0;
+    request_handles.clear();
+    request_mapped_buffers.clear();
+    for (auto& buffer : static_buffers)
+        buffer.clear();
+}
+
 SharedPtr<Object> HLERequestContext::GetIncomingHandle(u32 id_from_cmdbuf) const {
     ASSERT(id_from_cmdbuf < request_handles.size());
     return request_handles[id_from_cmdbuf];
@@ -129,11 +138,11 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* sr
         case IPC::DescriptorType::StaticBuffer: {
             VAddr source_address{src_cmdbuf[i]};
             IPC::StaticBufferDescInfo buffer_info{descriptor};
-            // Copy the input buffer into our own vector and store it.
-            std::vector<u8> data(buffer_info.size);
+            // Copy the input buffer into our own vector, reusing its storage.
+            auto& data{static_buffers[buffer_info.buffer_id]};
+            data.resize(buffer_info.size);
             src_process.system.Memory().ReadBlock(src_process, source_address, data.data(),
                                                   data.size());
-            AddStaticBuffer(buffer_info.buffer_id, std::move(data));
             cmd_buf[i++] = source_address;
             break;
         }
@@ -170,9 +179,9 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf,
             for (u32 j{}; j < num_handles; ++j) {
                 auto object{GetIncomingHandle(cmd_buf[i])};
                 Handle handle{};
-                if (object)
-                    // TODO: Figure out the proper error handling for if this fails
-                    handle = dst_process.handle_table.Create(object);
+                if (object) {
+                    CASCADE_RESULT(handle, dst_process.handle_table.Create(object));
+                }
                 dst_cmdbuf[i++] = handle;
             }
             break;
@@ -229,4 +238,18 @@ void MappedBuffer::Write(const void* src_buffer, std::size_t offset, std::size_t
                                         size);
 }
 
+Memory::MemorySpans MappedBuffer::GetReadSpans(std::size_t offset, std::size_t size) {
+    ASSERT(perms & IPC::R);
+    ASSERT(offset + size <= this->size);
+    return process->system.Memory().GetBlockSpans(*process, address + static_cast<VAddr>(offset),
+                                                  size, Memory::FlushMode::Flush);
+}
+
+Memory::MemorySpans MappedBuffer::GetWriteSpans(std::size_t offset, std::size_t size) {
+    ASSERT(perms & IPC::W);
+    ASSERT(offset + size <= this->size);
+    return process->system.Memory().GetBlockSpans(*process, address + static_cast<VAddr>(offset),
+                                                  size, Memory::FlushMode::Invalidate);
+}
+
 } // namespace Kernel
@@ -16,6 +16,7 @@
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/memory.h"
 
 namespace Service {
 class ServiceFrameworkBase;
@@ -102,6 +103,11 @@ public:
     void Read(void* dest_buffer, std::size_t offset, std::size_t size);
     void Write(const void* src_buffer, std::size_t offset, std::size_t size);
 
+    /// Gets the guest memory backing part of the buffer, for reading it in place.
+    Memory::MemorySpans GetReadSpans(std::size_t offset, std::size_t size);
+    /// Gets the guest memory backing part of the buffer, for writing it in place.
+    Memory::MemorySpans GetWriteSpans(std::size_t offset, std::size_t size);
+
     std::size_t GetSize() const {
         return size;
     }
@@ -158,6 +164,12 @@ public:
     HLERequestContext(SharedPtr<ServerSession> session);
     ~HLERequestContext();
 
+    /**
+     * Prepares the context for another request, releasing the objects of the previous one. The
+     * storage of the static buffers is kept, so reusing a context doesn't allocate.
+     */
+    void Reset(SharedPtr<ServerSession> session);
+
     /// Returns a pointer to the IPC command buffer for this request.
     u32* CommandBuffer() {
         return cmd_buf.data();
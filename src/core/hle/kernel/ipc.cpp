@@ -66,8 +66,9 @@ ResultCode TranslateCommandBuffer(SharedPtr<Thread> src_thread, SharedPtr<Thread
                     cmd_buf[i++] = 0;
                     continue;
                 }
-                auto result{dst_process->handle_table.Create(std::move(object))};
-                cmd_buf[i++] = result;
+                CASCADE_RESULT(const Handle translated,
+                               dst_process->handle_table.Create(std::move(object)));
+                cmd_buf[i++] = translated;
             }
             break;
         }
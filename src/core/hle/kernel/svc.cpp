@@ -330,7 +330,7 @@ ResultCode SVC::ConnectToPort(Handle* out_handle, VAddr port_name_address) {
     SharedPtr<ClientSession> client_session;
     CASCADE_RESULT(client_session, client_port->Connect());
     // Return the client session
-    *out_handle = kernel.GetCurrentProcess()->handle_table.Create(client_session);
+    CASCADE_RESULT(*out_handle, kernel.GetCurrentProcess()->handle_table.Create(client_session));
     return RESULT_SUCCESS;
 }
 
@@ -620,7 +620,8 @@ ResultCode SVC::ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_co
 /// Create an address arbiter (to allocate access to shared resources)
 ResultCode SVC::CreateAddressArbiter(Handle* out_handle) {
     auto arbiter{kernel.CreateAddressArbiter()};
-    *out_handle = kernel.GetCurrentProcess()->handle_table.Create(std::move(arbiter));
+    CASCADE_RESULT(*out_handle,
+                   kernel.GetCurrentProcess()->handle_table.Create(std::move(arbiter)));
     LOG_TRACE(Kernel_SVC, "returned handle: 0x{:08X}", *out_handle);
     return RESULT_SUCCESS;
 }
@@ -676,7 +677,7 @@ ResultCode SVC::GetResourceLimit(Handle* resource_limit, Handle process_handle)
     auto process{current_process->handle_table.Get<Process>(process_handle)};
     if (!process)
         return ERR_INVALID_HANDLE;
-    *resource_limit = current_process->handle_table.Create(process->resource_limit);
+    CASCADE_RESULT(*resource_limit, current_process->handle_table.Create(process->resource_limit));
     return RESULT_SUCCESS;
 }
 
@@ -755,7 +756,7 @@ ResultCode SVC::CreateThread(Handle* out_handle, u32 entry_point, u32 arg, VAddr
                                                     stack_top, *current_process));
     thread->context->SetFpscr(FPSCR_DEFAULT_NAN | FPSCR_FLUSH_TO_ZERO |
                               FPSCR_ROUND_TOZERO); // 0x03C00000
-    *out_handle = current_process->handle_table.Create(std::move(thread));
+    CASCADE_RESULT(*out_handle, current_process->handle_table.Create(std::move(thread)));
     system.PrepareReschedule();
     LOG_TRACE(Kernel_SVC,
               "entrypoint=0x{:08X} ({}), arg=0x{:08X}, stacktop=0x{:08X}, "
@@ -805,7 +806,7 @@ ResultCode SVC::SetThreadPriority(Handle handle, u32 priority) {
 ResultCode SVC::CreateMutex(Handle* out_handle, u32 initial_locked) {
     auto mutex{kernel.CreateMutex(initial_locked != 0)};
     mutex->name = fmt::format("mutex-{:08x}", system.CPU().GetReg(14));
-    *out_handle = kernel.GetCurrentProcess()->handle_table.Create(std::move(mutex));
+    CASCADE_RESULT(*out_handle, kernel.GetCurrentProcess()->handle_table.Create(std::move(mutex)));
     LOG_TRACE(Kernel_SVC, "initial_locked={}, created handle: 0x{:08X}",
               initial_locked ? "true" : "false", *out_handle);
     return RESULT_SUCCESS;
@@ -856,7 +857,8 @@ ResultCode SVC::GetThreadID(u32* thread_id, Handle handle) {
 ResultCode SVC::CreateSemaphore(Handle* out_handle, s32 initial_count, s32 max_count) {
     CASCADE_RESULT(auto semaphore, kernel.CreateSemaphore(initial_count, max_count));
     semaphore->name = fmt::format("semaphore-{:08x}", system.CPU().GetReg(14));
-    *out_handle = kernel.GetCurrentProcess()->handle_table.Create(std::move(semaphore));
+    CASCADE_RESULT(*out_handle,
+                   kernel.GetCurrentProcess()->handle_table.Create(std::move(semaphore)));
     LOG_TRACE(Kernel_SVC, "initial_count={}, max_count={}, created handle=0x{:08X}", initial_count,
               max_count, *out_handle);
     return RESULT_SUCCESS;
@@ -911,7 +913,7 @@ ResultCode SVC::QueryMemory(MemoryInfo* memory_info, PageInfo* page_info, u32 ad
 ResultCode SVC::CreateEvent(Handle* out_handle, u32 reset_type) {
     auto evt{kernel.CreateEvent(static_cast<ResetType>(reset_type),
                                 fmt::format("event-{:08x}", system.CPU().GetReg(14)))};
-    *out_handle = kernel.GetCurrentProcess()->handle_table.Create(std::move(evt));
+    CASCADE_RESULT(*out_handle, kernel.GetCurrentProcess()->handle_table.Create(std::move(evt)));
     LOG_TRACE(Kernel_SVC, "reset_type=0x{:08X}. created handle: 0x{:08X}", reset_type, *out_handle);
     return RESULT_SUCCESS;
 }
@@ -947,7 +949,7 @@ ResultCode SVC::ClearEvent(Handle handle) {
 ResultCode SVC::CreateTimer(Handle* out_handle, u32 reset_type) {
     auto timer{kernel.CreateTimer(static_cast<ResetType>(reset_type),
                                   fmt ::format("timer-{:08x}", system.CPU().GetReg(14)))};
-    *out_handle = kernel.GetCurrentProcess()->handle_table.Create(std::move(timer));
+    CASCADE_RESULT(*out_handle, kernel.GetCurrentProcess()->handle_table.Create(std::move(timer)));
     LOG_TRACE(Kernel_SVC, "reset_type=0x{:08X}, created handle: 0x{:08X}", reset_type, *out_handle);
     return RESULT_SUCCESS;
 }
@@ -1048,7 +1050,7 @@ ResultCode SVC::CreateMemoryBlock(Handle* out_handle, u32 addr, u32 size, u32 my
                    kernel.CreateSharedMemory(
                        current_process.get(), size, static_cast<MemoryPermission>(my_permission),
                        static_cast<MemoryPermission>(other_permission), addr, region));
-    *out_handle = current_process->handle_table.Create(std::move(shared_memory));
+    CASCADE_RESULT(*out_handle, current_process->handle_table.Create(std::move(shared_memory)));
     LOG_WARNING(Kernel_SVC, "called addr=0x{:08X}", addr);
     return RESULT_SUCCESS;
 }
@@ -1059,10 +1061,15 @@ ResultCode SVC::CreatePort(Handle* server_port, Handle* client_port, VAddr name_
     ASSERT_MSG(name_address == 0, "Named ports are currently unimplemented");
     auto current_process{kernel.GetCurrentProcess()};
     auto ports{kernel.CreatePortPair(max_sessions)};
-    *client_port =
-        current_process->handle_table.Create(std::move(std::get<SharedPtr<ClientPort>>(ports)));
-    *server_port =
-        current_process->handle_table.Create(std::move(std::get<SharedPtr<ServerPort>>(ports)));
+    CASCADE_RESULT(*client_port, current_process->handle_table.Create(
+                                     std::move(std::get<SharedPtr<ClientPort>>(ports))));
+    auto server_port_handle{
+        current_process->handle_table.Create(std::move(std::get<SharedPtr<ServerPort>>(ports)))};
+    if (server_port_handle.Failed()) {
+        current_process->handle_table.Close(*client_port);
+        return server_port_handle.Code();
+    }
+    *server_port = *server_port_handle;
     LOG_TRACE(Kernel_SVC, "max_sessions={}", max_sessions);
     return RESULT_SUCCESS;
 }
@@ -1073,7 +1080,7 @@ ResultCode SVC::CreateSessionToPort(Handle* out_client_session, Handle client_po
     if (!client_port)
         return ERR_INVALID_HANDLE;
     CASCADE_RESULT(auto session, client_port->Connect());
-    *out_client_session = current_process->handle_table.Create(std::move(session));
+    CASCADE_RESULT(*out_client_session, current_process->handle_table.Create(std::move(session)));
     return RESULT_SUCCESS;
 }
 
@@ -1081,9 +1088,14 @@ ResultCode SVC::CreateSession(Handle* server_session, Handle* client_session) {
     auto sessions{kernel.CreateSessionPair()};
     auto current_process{kernel.GetCurrentProcess()};
     auto& server{std::get<SharedPtr<ServerSession>>(sessions)};
-    *server_session = current_process->handle_table.Create(std::move(server));
+    CASCADE_RESULT(*server_session, current_process->handle_table.Create(std::move(server)));
     auto& client{std::get<SharedPtr<ClientSession>>(sessions)};
-    *client_session = current_process->handle_table.Create(std::move(client));
+    auto client_session_handle{current_process->handle_table.Create(std::move(client))};
+    if (client_session_handle.Failed()) {
+        current_process->handle_table.Close(*server_session);
+        return client_session_handle.Code();
+    }
+    *client_session = *client_session_handle;
     LOG_TRACE(Kernel_SVC, "called");
     return RESULT_SUCCESS;
 }
@@ -1094,7 +1106,7 @@ ResultCode SVC::AcceptSession(Handle* out_server_session, Handle server_port_han
     if (!server_port)
         return ERR_INVALID_HANDLE;
     CASCADE_RESULT(auto session, server_port->Accept());
-    *out_server_session = current_process->handle_table.Create(std::move(session));
+    CASCADE_RESULT(*out_server_session, current_process->handle_table.Create(std::move(session)));
     return RESULT_SUCCESS;
 }
 
@@ -1320,7 +1332,7 @@ const SVC::FunctionDef* SVC::GetSVCInfo(u32 func_num) {
 
 void SVC::CallSVC(u32 immediate) {
     // Lock the global kernel mutex when we enter the kernel HLE.
-    std::lock_guard lock{HLE::g_hle_lock};
+    HLE::HLELockGuard lock{"SVC::CallSVC"};
     DEBUG_ASSERT_MSG(kernel.GetCurrentProcess()->status == ProcessStatus::Running,
                      "Running threads from exiting processes is unimplemented");
     const auto info{GetSVCInfo(immediate)};
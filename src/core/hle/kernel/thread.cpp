@@ -4,8 +4,8 @@
 
 #include <algorithm>
 #include <list>
-#include <unordered_map>
 #include <vector>
+#include <boost/container/small_vector.hpp>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
@@ -47,8 +47,8 @@ Thread* ThreadManager::GetCurrentThread() const {
 
 void Thread::Stop() {
     // Cancel any outstanding wakeup events for this thread
-    system.CoreTiming().UnscheduleEvent(thread_manager.ThreadWakeupEventType, thread_id);
-    thread_manager.wakeup_callback_table.erase(thread_id);
+    system.CoreTiming().UnscheduleEvent(thread_manager.ThreadWakeupEventType,
+                                        reinterpret_cast<u64>(this));
     // Clean up thread from ready queue
     // This is only needed when the thread is termintated forcefully (SVC TerminateProcess)
     if (status == ThreadStatus::Ready)
@@ -70,14 +70,18 @@ void Thread::Stop() {
 
 /// Boost low priority threads (temporarily) that have been starved
 void ThreadManager::PriorityBoostStarvedThreads() {
-    u64 current_ticks{system.CoreTiming().GetTicks()};
-    for (auto& thread : thread_list) {
-        const u64 boost_timeout{2000000}; // Boost threads that have been ready for > this long
-        u64 delta{current_ticks - thread->last_running_ticks};
-        if (thread->status == Kernel::ThreadStatus::Ready && delta > boost_timeout) {
-            const u32 priority{std::max(ready_queue.get_first()->current_priority - 1, 40u)};
-            thread->BoostPriority(priority);
-        }
+    const u64 current_ticks{system.CoreTiming().GetTicks()};
+    const u64 boost_timeout{2000000}; // Boost threads that have been ready for > this long
+    // Only ready threads can be starved, so there's no need to look at the whole thread list.
+    // Boosting moves threads between queues, so collect them first.
+    boost::container::small_vector<Thread*, 16> starved;
+    ready_queue.for_each([&](Thread* thread) {
+        if (current_ticks - thread->last_running_ticks > boost_timeout)
+            starved.push_back(thread);
+    });
+    for (auto thread : starved) {
+        const u32 priority{std::max(ready_queue.get_first()->current_priority - 1, 40u)};
+        thread->BoostPriority(priority);
     }
 }
 
@@ -100,7 +104,7 @@ void ThreadManager::SwitchContext(Thread* new_thread) {
         ASSERT_MSG(new_thread->status == ThreadStatus::Ready,
                    "Thread must be ready to become running.");
         // Cancel any outstanding wakeup events for this thread
-        timing.UnscheduleEvent(ThreadWakeupEventType, new_thread->thread_id);
+        timing.UnscheduleEvent(ThreadWakeupEventType, reinterpret_cast<u64>(new_thread));
         auto& kernel{system.Kernel()};
         auto previous_process{kernel.GetCurrentProcess()};
         current_thread = new_thread;
@@ -149,12 +153,9 @@ void ThreadManager::ExitCurrentThread() {
                       thread_list.end());
 }
 
-void ThreadManager::ThreadWakeupCallback(u64 thread_id, s64 cycles_late) {
-    auto thread{wakeup_callback_table.at(thread_id)};
-    if (!thread) {
-        LOG_ERROR(Kernel, "Callback fired for invalid thread {:08X}", thread_id);
-        return;
-    }
+void ThreadManager::ThreadWakeupCallback(u64 userdata, s64 cycles_late) {
+    // The event is unscheduled when the thread stops, so the pointer is always valid here
+    auto thread{reinterpret_cast<Thread*>(userdata)};
     if (thread->status == ThreadStatus::WaitSynchAny ||
         thread->status == ThreadStatus::WaitSynchAll || thread->status == ThreadStatus::WaitArb ||
         thread->status == ThreadStatus::WaitHleEvent) {
@@ -174,7 +175,7 @@ void Thread::WakeAfterDelay(s64 nanoseconds) {
     if (nanoseconds == -1)
         return;
     system.CoreTiming().ScheduleEvent(nsToCycles(nanoseconds), thread_manager.ThreadWakeupEventType,
-                                      thread_id);
+                                      reinterpret_cast<u64>(this));
 }
 
 void Thread::ResumeFromWait() {
@@ -269,7 +270,6 @@ ResultVal<SharedPtr<Thread>> KernelSystem::CreateThread(std::string name, VAddr
     }
     SharedPtr<Thread> thread{new Thread(*this)};
     thread_manager->thread_list.push_back(thread);
-    thread_manager->ready_queue.prepare(priority);
     thread->thread_id = thread_manager->NewThreadID();
     thread->status = ThreadStatus::Dormant;
     thread->entry_point = entry_point;
@@ -280,7 +280,6 @@ ResultVal<SharedPtr<Thread>> KernelSystem::CreateThread(std::string name, VAddr
     thread->wait_objects.clear();
     thread->wait_address = 0;
     thread->name = std::move(name);
-    thread_manager->wakeup_callback_table[thread->thread_id] = thread.get();
     thread->owner_process = &owner_process;
     // Find the next available TLS index, and mark it as used
     auto& tls_slots{owner_process.tls_slots};
@@ -326,8 +325,6 @@ void Thread::SetPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
         thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
     nominal_priority = current_priority = priority;
 }
 
@@ -343,8 +340,6 @@ void Thread::BoostPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
         thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
     current_priority = priority;
 }
 
@@ -402,7 +397,7 @@ VAddr Thread::GetCommandBufferAddress() const {
 ThreadManager::ThreadManager(Core::System& system) : system{system} {
     ThreadWakeupEventType = system.CoreTiming().RegisterEvent(
         "ThreadManager Wakeup Event",
-        [this](u64 thread_id, s64 cycle_late) { ThreadWakeupCallback(thread_id, cycle_late); });
+        [this](u64 userdata, s64 cycle_late) { ThreadWakeupCallback(userdata, cycle_late); });
 }
 
 ThreadManager::~ThreadManager() {
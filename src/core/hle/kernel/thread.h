@@ -103,11 +103,11 @@ private:
 
     /**
      * Callback that will wake up the thread it was scheduled for
-     * @param thread_id The ID of the thread that's been awoken
+     * @param userdata Pointer to the thread that's been awoken
      * @param cycles_late The number of CPU cycles that have passed since the desired wakeup
      * time
      */
-    void ThreadWakeupCallback(u64 thread_id, s64 cycles_late);
+    void ThreadWakeupCallback(u64 userdata, s64 cycles_late);
 
     /// Boost low priority threads (temporarily) that have been starved
     void PriorityBoostStarvedThreads();
@@ -115,7 +115,6 @@ private:
     u32 next_thread_id{1};
     SharedPtr<Thread> current_thread;
     Common::ThreadQueueList<Thread*, ThreadPrioLowest + 1> ready_queue;
-    std::unordered_map<u64, Thread*> wakeup_callback_table;
 
     /// Event type for the thread wake up event
     Core::TimingEventType* ThreadWakeupEventType;
@@ -61,19 +61,20 @@ VMManager::VMAHandle VMManager::FindVMA(VAddr target) const {
 
 ResultVal<VAddr> VMManager::MapBackingMemoryToBase(VAddr base, u32 region_size, u8* memory,
                                                    u32 size, MemoryState state) {
-    // Find the first Free VMA.
-    auto vma_handle{std::find_if(vma_map.begin(), vma_map.end(), [&](const auto& vma) {
+    // Find the first Free VMA that fits the block, starting at the VMA that contains the base
+    auto vma_handle{std::find_if(FindVMA(base), vma_map.cend(), [&](const auto& vma) {
         if (vma.second.type != VMAType::Free)
             return false;
-        VAddr vma_end = vma.second.base + vma.second.size;
-        return vma_end > base && vma_end >= base + size;
+        VAddr vma_end{vma.second.base + vma.second.size};
+        return vma_end >= std::max(base, vma.second.base) + size;
     })};
-    auto target{std::max(base, vma_handle->second.base)};
     // Don't try to allocate the block if there are no available addresses within the desired
     // region.
-    if (vma_handle == vma_map.end() || target + size > base + region_size)
+    if (vma_handle == vma_map.end() ||
+        std::max(base, vma_handle->second.base) + size > base + region_size)
         return ResultCode(ErrorDescription::OutOfMemory, ErrorModule::Kernel,
                           ErrorSummary::OutOfResource, ErrorLevel::Permanent);
+    auto target{std::max(base, vma_handle->second.base)};
     auto result{MapBackingMemory(target, memory, size, state)};
     if (result.Failed())
         return result.Code();
@@ -129,9 +130,9 @@ ResultCode VMManager::ChangeMemoryState(VAddr target, u32 size, MemoryState expe
     }
     CASCADE_RESULT(auto vma, CarveVMARange(target, size));
     ASSERT(vma->second.size == size);
+    // The page table doesn't hold permissions or states, so it doesn't need to be updated
     vma->second.permissions = new_perms;
     vma->second.meminfo_state = new_state;
-    UpdatePageTableForVMA(vma->second);
     MergeAdjacent(vma);
     return RESULT_SUCCESS;
 }
@@ -143,7 +144,6 @@ VMManager::VMAIter VMManager::Unmap(VMAIter vma_handle) {
     vma.meminfo_state = MemoryState::Free;
     vma.backing_memory = nullptr;
     vma.paddr = 0;
-    UpdatePageTableForVMA(vma);
     return MergeAdjacent(vma_handle);
 }
 
@@ -156,14 +156,15 @@ ResultCode VMManager::UnmapRange(VAddr target, u32 size) {
     while (vma != end && vma->second.base < target_end)
         vma = std::next(Unmap(vma));
     ASSERT(FindVMA(target)->second.size >= size);
+    // The whole range is unmapped from the page table at once instead of once per VMA
+    memory.UnmapRegion(page_table, target, size);
     return RESULT_SUCCESS;
 }
 
 VMManager::VMAHandle VMManager::Reprotect(VMAHandle vma_handle, VMAPermission new_perms) {
     auto iter{StripIterConstness(vma_handle)};
-    auto& vma{iter->second};
-    vma.permissions = new_perms;
-    UpdatePageTableForVMA(vma);
+    // The page table doesn't hold permissions, so it doesn't need to be updated
+    iter->second.permissions = new_perms;
     return MergeAdjacent(iter);
 }
 
@@ -189,7 +189,7 @@ private:
     /// Converts a VMAHandle to a mutable VMAIter.
     VMAIter StripIterConstness(const VMAHandle& iter);
 
-    /// Unmaps the given VMA.
+    /// Marks the given VMA as free. The caller is responsible for updating the page table.
     VMAIter Unmap(VMAIter vma);
 
     /**
@@ -2,8 +2,106 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include "common/logging/log.h"
 #include "core/hle/lock.h"
 
 namespace HLE {
-std::recursive_mutex g_hle_lock;
+
+HLELock g_hle_lock;
+
+void HLELock::Lock(const char* site) {
+    if (!instrumented.load(std::memory_order_relaxed)) {
+        mutex.lock();
+        ++depth;
+        return;
+    }
+    const auto start{Clock::now()};
+    const bool contended{!mutex.try_lock()};
+    if (contended)
+        mutex.lock();
+    Acquired(site, start, contended);
+}
+
+bool HLELock::try_lock() {
+    const auto start{Clock::now()};
+    if (!mutex.try_lock())
+        return false;
+    if (instrumented.load(std::memory_order_relaxed))
+        Acquired("try_lock", start, false);
+    else
+        ++depth;
+    return true;
+}
+
+void HLELock::Acquired(const char* site, Clock::time_point start, bool contended) {
+    if (depth++ != 0)
+        return;
+    const auto now{Clock::now()};
+    const std::chrono::nanoseconds wait{now - start};
+    timing_hold = true;
+    owner_site = site;
+    acquired_at = now;
+    std::lock_guard lock{stats_mutex};
+    auto& site_stats{stats[site]};
+    site_stats.site = site;
+    ++site_stats.acquisitions;
+    if (contended)
+        ++site_stats.contended_acquisitions;
+    site_stats.total_wait += wait;
+    site_stats.max_wait = std::max(site_stats.max_wait, wait);
+}
+
+void HLELock::unlock() {
+    if (--depth == 0 && timing_hold) {
+        timing_hold = false;
+        const std::chrono::nanoseconds hold{Clock::now() - acquired_at};
+        std::lock_guard lock{stats_mutex};
+        auto& site_stats{stats[owner_site]};
+        site_stats.site = owner_site;
+        site_stats.total_hold += hold;
+        site_stats.max_hold = std::max(site_stats.max_hold, hold);
+    }
+    mutex.unlock();
+}
+
+void HLELock::SetInstrumentationEnabled(bool enabled) {
+    instrumented = enabled;
+}
+
+bool HLELock::IsInstrumentationEnabled() const {
+    return instrumented;
+}
+
+std::vector<LockSiteStats> HLELock::GetStats() const {
+    std::lock_guard lock{stats_mutex};
+    std::vector<LockSiteStats> result;
+    result.reserve(stats.size());
+    for (const auto& [site, site_stats] : stats)
+        result.push_back(site_stats);
+    std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+        return a.total_wait > b.total_wait;
+    });
+    return result;
+}
+
+void HLELock::ResetStats() {
+    std::lock_guard lock{stats_mutex};
+    stats.clear();
+}
+
+void HLELock::LogStats() const {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    for (const auto& site_stats : GetStats())
+        LOG_INFO(Kernel,
+                 "HLE lock {}: {} acquisitions ({} contended), wait total={}us max={}us, hold "
+                 "total={}us max={}us",
+                 site_stats.site, site_stats.acquisitions, site_stats.contended_acquisitions,
+                 duration_cast<microseconds>(site_stats.total_wait).count(),
+                 duration_cast<microseconds>(site_stats.max_wait).count(),
+                 duration_cast<microseconds>(site_stats.total_hold).count(),
+                 duration_cast<microseconds>(site_stats.max_hold).count());
+}
+
 } // namespace HLE
@@ -4,10 +4,71 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
 
 namespace HLE {
 
+/// Wait and hold time statistics of one call site of the HLE lock
+struct LockSiteStats {
+    std::string_view site;
+    u64 acquisitions{};
+    u64 contended_acquisitions{};
+    std::chrono::nanoseconds total_wait{};
+    std::chrono::nanoseconds max_wait{};
+    std::chrono::nanoseconds total_hold{};
+    std::chrono::nanoseconds max_hold{};
+};
+
+/**
+ * Recursive mutex that can record, for each call site, how long it waits for the lock and how
+ * long it holds it. Recording is disabled by default since it adds clock reads to every
+ * acquisition. Only the outermost acquisition of a thread is recorded.
+ */
+class HLELock {
+public:
+    void lock() {
+        Lock("unnamed");
+    }
+
+    void unlock();
+    bool try_lock();
+
+    /// Acquires the lock on behalf of the named call site. `site` must outlive the lock.
+    void Lock(const char* site);
+
+    void SetInstrumentationEnabled(bool enabled);
+    bool IsInstrumentationEnabled() const;
+
+    std::vector<LockSiteStats> GetStats() const;
+    void ResetStats();
+
+    /// Logs the statistics of every call site, most contended first
+    void LogStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Acquired(const char* site, Clock::time_point start, bool contended);
+
+    std::recursive_mutex mutex;
+    std::atomic_bool instrumented{};
+
+    // These are only accessed by the thread owning the lock
+    u32 depth{};
+    bool timing_hold{};
+    const char* owner_site{};
+    Clock::time_point acquired_at;
+
+    mutable std::mutex stats_mutex;
+    std::unordered_map<std::string_view, LockSiteStats> stats;
+};
+
 /*
  * Synchronizes access to the internal HLE kernel structures, it's acquired when a guest
  * program thread performs a syscall. It should be acquired by any host threads that read or
@@ -16,6 +77,21 @@ namespace HLE {
  * than the CPU thread.
  */
 
-extern std::recursive_mutex g_hle_lock;
+extern HLELock g_hle_lock;
+
+/// Acquires the HLE lock for the lifetime of the guard, on behalf of the named call site.
+class HLELockGuard {
+public:
+    explicit HLELockGuard(const char* site) {
+        g_hle_lock.Lock(site);
+    }
+
+    ~HLELockGuard() {
+        g_hle_lock.unlock();
+    }
+
+    HLELockGuard(const HLELockGuard&) = delete;
+    HLELockGuard& operator=(const HLELockGuard&) = delete;
+};
 
 } // namespace HLE
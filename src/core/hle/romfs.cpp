@@ -44,10 +44,50 @@ struct FileMetadata {
 };
 static_assert(sizeof(FileMetadata) == 0x20, "FileMetadata has incorrect size");
 
+constexpr u32 INVALID_FIELD{0xFFFFFFFF};
+
 static bool MatchName(const u8* buffer, u32 name_length, const std::u16string& name) {
-    std::vector<char16_t> name_buffer(name_length / sizeof(char16_t));
-    std::memcpy(name_buffer.data(), buffer, name_length);
-    return name == std::u16string(name_buffer.begin(), name_buffer.end());
+    return name_length == name.size() * sizeof(char16_t) &&
+           std::memcmp(buffer, name.data(), name_length) == 0;
+}
+
+/// Hash used by the RomFS hash tables to place an entry, from its parent and its name
+static u32 CalculatePathHash(u32 parent_offset, const std::u16string& name) {
+    u32 hash{parent_offset ^ 123456789};
+    for (char16_t c : name) {
+        hash = (hash >> 5) | (hash << 27);
+        hash ^= static_cast<u16>(c);
+    }
+    return hash;
+}
+
+/**
+ * Looks up an entry in one of the RomFS hash tables, so that finding an entry doesn't depend on
+ * the amount of siblings it has.
+ * @return The offset of the entry in its metadata table, or INVALID_FIELD if it wasn't found
+ */
+template <typename Metadata>
+static u32 FindEntry(const u8* romfs, u32 hash_table_offset, u32 hash_table_length,
+                     u32 table_offset, u32_le Metadata::*same_hash_next, u32 parent_offset,
+                     const std::u16string& name) {
+    const u32 bucket_count{hash_table_length / static_cast<u32>(sizeof(u32_le))};
+    if (bucket_count == 0)
+        return INVALID_FIELD;
+    u32_le entry_offset;
+    std::memcpy(&entry_offset,
+                romfs + hash_table_offset +
+                    CalculatePathHash(parent_offset, name) % bucket_count * sizeof(u32_le),
+                sizeof(entry_offset));
+    Metadata entry;
+    for (u32 offset{entry_offset}; offset != INVALID_FIELD;
+         offset = entry.*same_hash_next) {
+        const u8* current{romfs + table_offset + offset};
+        std::memcpy(&entry, current, sizeof(entry));
+        if (entry.parent_dir_offset == parent_offset &&
+            MatchName(current + sizeof(entry), entry.name_length, name))
+            return offset;
+    }
+    return INVALID_FIELD;
 }
 
 RomFSFile::RomFSFile(const u8* data, u64 length) : data{data}, length{length} {}
@@ -60,8 +100,8 @@ u64 RomFSFile::Length() const {
     return length;
 }
 
-const RomFSFile GetFile(const u8* romfs, const std::vector<std::u16string>& path) {
-    constexpr u32 INVALID_FIELD{0xFFFFFFFF};
+/// Finds a file by walking the children of every directory in the path
+static const RomFSFile WalkToFile(const u8* romfs, const std::vector<std::u16string>& path) {
     // Split path into directory names and file name
     std::vector<std::u16string> dir_names{path};
     dir_names.pop_back();
@@ -100,4 +140,28 @@ const RomFSFile GetFile(const u8* romfs, const std::vector<std::u16string>& path
     return RomFSFile();
 }
 
+const RomFSFile GetFile(const u8* romfs, const std::vector<std::u16string>& path) {
+    Header header;
+    std::memcpy(&header, romfs, sizeof(header));
+    // The root directory is the first entry of the directory table
+    u32 dir_offset{};
+    for (auto itr{path.begin()}; itr != path.end() - 1; ++itr) {
+        dir_offset = FindEntry(romfs, header.dir_hash_table_offset, header.dir_hash_table_length,
+                               header.dir_table_offset,
+                               &DirectoryMetadata::same_hash_next_dir_offset, dir_offset, *itr);
+        if (dir_offset == INVALID_FIELD)
+            // Images without usable hash tables can still be searched the slow way
+            return WalkToFile(romfs, path);
+    }
+    const u32 file_offset{FindEntry(romfs, header.file_hash_table_offset,
+                                    header.file_hash_table_length, header.file_table_offset,
+                                    &FileMetadata::same_hash_next_file_offset, dir_offset,
+                                    path.back())};
+    if (file_offset == INVALID_FIELD)
+        return WalkToFile(romfs, path);
+    FileMetadata file;
+    std::memcpy(&file, romfs + header.file_table_offset + file_offset, sizeof(file));
+    return RomFSFile(romfs + header.data_offset + file.data_offset, file.data_length);
+}
+
 } // namespace RomFS
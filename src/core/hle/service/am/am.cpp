@@ -3,15 +3,22 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <cstddef>
 #include <cstring>
+#include <deque>
+#include <future>
+#include <thread>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
 #include <fmt/format.h>
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/thread_pool.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/ncch_container.h"
@@ -42,6 +49,7 @@ constexpr u16 CATEGORY_DLP{0x0001};
 constexpr u8 VARIATION_SYSTEM{0x02};
 constexpr u32 PROGRAM_ID_HIGH_UPDATE{0x0004000E};
 constexpr u32 PROGRAM_ID_HIGH_DLC{0x0004008C};
+constexpr std::size_t CIA_READ_CHUNK_SIZE{0x100000};
 
 struct TitleInfo {
     u64_le pid;
@@ -53,13 +61,138 @@ struct TitleInfo {
 
 static_assert(sizeof(TitleInfo) == 0x18, "Title info structure size is wrong");
 
-class CIAFile::DecryptionState {
+/**
+ * Decrypts, hashes and writes content data in stages. Slices of different contents received in
+ * the same write are decoded in parallel, and decoded data is handed to a writer thread so that
+ * decoding the next write overlaps with writing out the previous one.
+ */
+class CIAFile::ContentPipeline {
 public:
-    std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+    struct Chunk {
+        u16 index;
+        std::shared_ptr<std::vector<u8>> data;
+        bool encrypted;
+        bool last;
+    };
+
+    void Resize(std::size_t content_count) {
+        hash.resize(content_count);
+        files.resize(content_count);
+    }
+
+    /// Decrypts and hashes a chunk in place
+    void Decode(const Chunk& chunk) {
+        auto& data{*chunk.data};
+        const auto start{Clock::now()};
+        if (chunk.encrypted)
+            decryption[chunk.index].ProcessData(data.data(), data.data(), data.size());
+        const auto decrypted{Clock::now()};
+        hash[chunk.index].Update(data.data(), data.size());
+        const auto hashed{Clock::now()};
+        if (chunk.encrypted) {
+            decrypt_stats.bytes += data.size();
+            decrypt_stats.time += Elapsed(start, decrypted);
+        }
+        hash_stats.bytes += data.size();
+        hash_stats.time += Elapsed(decrypted, hashed);
+    }
+
+    /// Decodes all chunks of a write, in parallel when they belong to different contents
+    void DecodeAll(const std::vector<Chunk>& chunks) {
+        std::vector<std::future<void>> results;
+        for (std::size_t i{1}; i < chunks.size(); ++i)
+            results.push_back(decoders.Push([this, &chunks, i] { Decode(chunks[i]); }));
+        if (!chunks.empty())
+            Decode(chunks[0]);
+        for (auto& result : results)
+            result.wait();
+    }
+
+    /// Returns whether the decrypted data of a content matches the hash from the TMD
+    bool VerifyHash(u16 index, const std::array<u8, 0x20>& expected) {
+        std::array<u8, CryptoPP::SHA256::DIGESTSIZE> digest;
+        hash[index].Final(digest.data());
+        return digest == expected;
+    }
+
+    /// Queues a decoded chunk for writing, waiting for the oldest write when too many are queued
+    void QueueWrite(Chunk chunk) {
+        while (pending_writes.size() >= MAX_PENDING_WRITES) {
+            pending_writes.front().wait();
+            pending_writes.pop_front();
+        }
+        pending_writes.push_back(writer.Push([this, chunk] {
+            auto& file{files[chunk.index]};
+            const auto start{Clock::now()};
+            if (file.WriteBytes(chunk.data->data(), chunk.data->size()) != chunk.data->size())
+                write_failed = true;
+            if (chunk.last)
+                file.Close();
+            write_stats.bytes += chunk.data->size();
+            write_stats.time += Elapsed(start, Clock::now());
+        }));
+    }
+
+    /// Waits for all queued writes and closes the content files
+    void Drain() {
+        for (auto& pending : pending_writes)
+            pending.wait();
+        pending_writes.clear();
+        for (auto& file : files)
+            file.Close();
+    }
+
+    void LogStats() {
+        if (!hash_stats.bytes)
+            return;
+        LOG_INFO(Service_AM, "Content install: decrypt {}, hash {}, write {}",
+                 decrypt_stats.Format(), hash_stats.Format(), write_stats.Format());
+        decrypt_stats.Reset();
+        hash_stats.Reset();
+        write_stats.Reset();
+    }
+
+    std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> decryption;
+    std::vector<FileUtil::IOFile> files;
+    std::atomic_bool write_failed{};
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct StageStats {
+        std::atomic<u64> bytes{};
+        std::atomic<u64> time{};
+
+        std::string Format() const {
+            const double mib{bytes / static_cast<double>(0x100000)};
+            const double seconds{time / 1e9};
+            return fmt::format("{:.1f} MiB at {:.1f} MiB/s", mib,
+                               seconds > 0 ? mib / seconds : 0.0);
+        }
+
+        void Reset() {
+            bytes = 0;
+            time = 0;
+        }
+    };
+
+    static u64 Elapsed(Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+
+    static constexpr std::size_t MAX_PENDING_WRITES{8};
+
+    std::vector<CryptoPP::SHA256> hash;
+    std::deque<std::future<void>> pending_writes;
+    StageStats decrypt_stats;
+    StageStats hash_stats;
+    StageStats write_stats;
+    Common::ThreadPool decoders{std::clamp(std::thread::hardware_concurrency(), 1U, 4U)};
+    Common::ThreadPool writer{1};
 };
 
 CIAFile::CIAFile(Service::FS::MediaType media_type)
-    : media_type{media_type}, decryption_state{std::make_unique<DecryptionState>()} {}
+    : media_type{media_type}, pipeline{std::make_unique<ContentPipeline>()} {}
 
 CIAFile::~CIAFile() {
     Close();
@@ -125,13 +258,14 @@ ResultCode CIAFile::WriteTitleMetadata() {
     FileUtil::CreateFullPath(program_folder);
     auto content_count{container.GetTitleMetadata().GetContentCount()};
     content_written.resize(content_count);
+    pipeline->Resize(content_count);
     auto title_key{container.GetTicket().GetTitleKey()};
     if (title_key) {
-        decryption_state->content.resize(content_count);
+        pipeline->decryption.resize(content_count);
         for (std::size_t i{}; i < content_count; ++i) {
             auto ctr{tmd.GetContentCTRByIndex(i)};
-            decryption_state->content[i].SetKeyWithIV(title_key->data(), title_key->size(),
-                                                      ctr.data());
+            pipeline->decryption[i].SetKeyWithIV(title_key->data(), title_key->size(),
+                                                 ctr.data());
         }
     }
     install_state = CIAInstallState::TMDLoaded;
@@ -142,8 +276,15 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
     // Data isn't being buffered, so we have to keep track of how much of each <ID>.app
     // has been written since we might get a written buffer which contains multiple .app
     // contents or only part of a larger .app's contents.
+    if (aborted)
+        return ResultCode(ErrCodes::InvalidCIAHeader, ErrorModule::AM,
+                          ErrorSummary::InvalidArgument, ErrorLevel::Permanent);
+    if (pipeline->write_failed)
+        return FileSys::ERROR_INSUFFICIENT_SPACE;
+    const FileSys::TitleMetadata& tmd{container.GetTitleMetadata()};
     u64 offset_max{offset + length};
-    for (int i{}; i < container.GetTitleMetadata().GetContentCount(); i++) {
+    std::vector<ContentPipeline::Chunk> chunks;
+    for (u16 i{}; i < tmd.GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(i)) {
             // The size, minimum unwritten offset, and maximum unwritten offset of this content
             u64 size{container.GetContentSize(i)};
@@ -151,32 +292,42 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
             u64 range_max{container.GetContentOffset(i) + size};
             // The unwritten range for this content is beyond the buffered data we have
             // or comes before the buffered data we have, so skip this content ID.
-            if (range_min > offset_max || range_max < offset)
+            if (range_min >= offset_max || range_max <= offset)
                 continue;
             // Figure out how much of this content ID we have just received/can write out
             u64 available_to_write{std::min(offset_max, range_max) - range_min};
             // Since the incoming TMD has already been written, we can use GetProgramContentPath
-            // to get the content paths to write to.
-            FileSys::TitleMetadata tmd{container.GetTitleMetadata()};
-            FileUtil::IOFile file{
-                GetProgramContentPath(media_type, tmd.GetProgramID(), i, is_update),
-                content_written[i] ? "ab" : "wb"};
-            if (!file.IsOpen())
+            // to get the content paths to write to. The file stays open until the content is
+            // complete.
+            if (!content_written[i] &&
+                !pipeline->files[i].Open(
+                    GetProgramContentPath(media_type, tmd.GetProgramID(), i, is_update), "wb"))
                 return FileSys::ERROR_INSUFFICIENT_SPACE;
-            std::vector<u8> temp(buffer + (range_min - offset),
-                                 buffer + (range_min - offset) + available_to_write);
-            if (tmd.GetContentTypeByIndex(static_cast<u16>(i)) &
-                FileSys::TMDContentTypeFlag::Encrypted) {
-                decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
-            }
-            file.WriteBytes(temp.data(), temp.size());
             // Keep tabs on how much of this content ID has been written so new range_min
             // values can be calculated.
             content_written[i] += available_to_write;
+            chunks.push_back({i,
+                              std::make_shared<std::vector<u8>>(
+                                  buffer + (range_min - offset),
+                                  buffer + (range_min - offset) + available_to_write),
+                              (tmd.GetContentTypeByIndex(i) &
+                               FileSys::TMDContentTypeFlag::Encrypted) != 0,
+                              content_written[i] == size});
             LOG_DEBUG(Service_AM, "Wrote {:x} to content {}, total {:x}", available_to_write, i,
                       content_written[i]);
         }
     }
+    pipeline->DecodeAll(chunks);
+    for (auto& chunk : chunks) {
+        if (chunk.last &&
+            !pipeline->VerifyHash(chunk.index, tmd.GetContentHashByIndex(chunk.index))) {
+            LOG_ERROR(Service_AM, "Hash mismatch in content {}", chunk.index);
+            aborted = true;
+            return ResultCode(ErrCodes::InvalidCIAHeader, ErrorModule::AM,
+                              ErrorSummary::InvalidArgument, ErrorLevel::Permanent);
+        }
+        pipeline->QueueWrite(std::move(chunk));
+    }
     return MakeResult<std::size_t>(length);
 }
 
@@ -211,13 +362,12 @@ ResultVal<std::size_t> CIAFile::Write(u64 offset, std::size_t length, bool flush
     if (offset < container.GetContentOffset()) {
         std::size_t buf_loaded{data.size()};
         std::size_t copy_offset{std::max(static_cast<std::size_t>(offset), buf_loaded)};
-        std::size_t buf_offset{buf_loaded - offset};
-        std::size_t buf_copy_size{
-            std::min(length, static_cast<std::size_t>(container.GetContentOffset() - offset)) -
-            buf_loaded};
         std::size_t buf_max_size{std::min(offset + length, container.GetContentOffset())};
-        data.resize(buf_max_size);
-        std::memcpy(data.data() + copy_offset, buffer + buf_offset, buf_copy_size);
+        if (buf_max_size > copy_offset) {
+            data.resize(buf_max_size);
+            std::memcpy(data.data() + copy_offset, buffer + (copy_offset - offset),
+                        buf_max_size - copy_offset);
+        }
     }
     // TODO: Write out .tik files to nand?
     // The end of our TMD is at the beginning of Content data, so ensure we have that much
@@ -249,7 +399,10 @@ bool CIAFile::SetSize(u64 size) const {
 }
 
 bool CIAFile::Close() const {
-    bool complete{true};
+    pipeline->Drain();
+    pipeline->LogStats();
+    // Content that failed verification or couldn't be written out counts as incomplete
+    bool complete{!aborted && !pipeline->write_failed};
     for (std::size_t i{}; i < container.GetTitleMetadata().GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(static_cast<u16>(i)))
             complete = false;
@@ -316,21 +469,43 @@ InstallStatus InstallCIA(const std::string& path,
         FileUtil::IOFile file{path, "rb"};
         if (!file.IsOpen())
             return InstallStatus::ErrorFailedToOpenFile;
-        std::array<u8, 0x10000> buffer;
+        const std::size_t file_size{file.GetSize()};
+        std::atomic<u64> read_time{};
+        auto read_chunk{[&file, &read_time, file_size](std::size_t offset) {
+            const auto start{std::chrono::steady_clock::now()};
+            std::vector<u8> chunk(std::min(CIA_READ_CHUNK_SIZE, file_size - offset));
+            chunk.resize(file.ReadAt(chunk.data(), chunk.size(), offset));
+            read_time += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+            return chunk;
+        }};
+        // The next chunk is read while the current one is being installed
+        auto next_chunk{std::async(std::launch::async, read_chunk, 0)};
         std::size_t total_bytes_read{};
-        while (total_bytes_read != file.GetSize()) {
-            std::size_t bytes_read{file.ReadBytes(buffer.data(), buffer.size())};
-            auto result{installFile.Write(static_cast<u64>(total_bytes_read), bytes_read, true,
-                                          static_cast<u8*>(buffer.data()))};
+        while (total_bytes_read != file_size) {
+            std::vector<u8> chunk{next_chunk.get()};
+            if (chunk.empty()) {
+                LOG_ERROR(Service_AM, "Failed to read {} at offset {:x}", path, total_bytes_read);
+                return InstallStatus::ErrorAborted;
+            }
+            if (total_bytes_read + chunk.size() != file_size)
+                next_chunk = std::async(std::launch::async, read_chunk,
+                                        total_bytes_read + chunk.size());
+            auto result{installFile.Write(static_cast<u64>(total_bytes_read), chunk.size(), true,
+                                          chunk.data())};
             if (update_callback)
-                update_callback(total_bytes_read, file.GetSize());
+                update_callback(total_bytes_read, file_size);
             if (result.Failed()) {
                 LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
                           result.Code().raw);
                 return InstallStatus::ErrorAborted;
             }
-            total_bytes_read += bytes_read;
+            total_bytes_read += chunk.size();
         }
+        const double read_seconds{read_time / 1e9};
+        LOG_INFO(Service_AM, "Read {:.1f} MiB at {:.1f} MiB/s", file_size / double{0x100000},
+                 read_seconds > 0 ? file_size / double{0x100000} / read_seconds : 0.0);
         installFile.Close();
         LOG_INFO(Service_AM, "Installed {} successfully.", path);
         return InstallStatus::Success;
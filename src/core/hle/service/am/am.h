@@ -93,9 +93,11 @@ private:
     std::vector<u8> data;
     std::vector<u64> content_written;
     Service::FS::MediaType media_type;
+    /// Set when content failed verification, so that the install is discarded on Close
+    bool aborted{};
 
-    class DecryptionState;
-    std::unique_ptr<DecryptionState> decryption_state;
+    class ContentPipeline;
+    std::unique_ptr<ContentPipeline> pipeline;
 };
 
 /**
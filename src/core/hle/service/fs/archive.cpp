@@ -51,10 +51,23 @@ ResultVal<ArchiveHandle> ArchiveManager::OpenArchive(ArchiveIDCode id_code,
 }
 
 ResultCode ArchiveManager::CloseArchive(ArchiveHandle handle) {
-    if (handle_map.erase(handle) == 0)
+    auto itr{handle_map.find(handle)};
+    if (itr == handle_map.end())
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
+    itr->second->Commit();
+    handle_map.erase(itr);
+    return RESULT_SUCCESS;
+}
+
+ResultCode ArchiveManager::ControlArchive(ArchiveHandle handle, u32 action) {
+    auto archive{GetArchive(handle)};
+    if (!archive)
+        return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
+    if (action == 0)
+        archive->Commit();
     else
-        return RESULT_SUCCESS;
+        LOG_WARNING(Service_FS, "(stubbed) Unknown action {} on {}", action, archive->GetName());
+    return RESULT_SUCCESS;
 }
 
 // TODO: This might be what the fs:REG service is for. See the Register/Unregister calls in
@@ -10,6 +10,7 @@
 #include <vector>
 #include <boost/container/flat_map.hpp>
 #include "common/common_types.h"
+#include "common/thread_pool.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/result.h"
 #include "core/hle/service/fs/directory.h"
@@ -71,6 +72,14 @@ public:
      */
     ResultCode CloseArchive(ArchiveHandle handle);
 
+    /**
+     * Performs an archive specific action
+     * @param handle Handle to the archive
+     * @param action The action to perform, 0 commits the save data
+     * @return ResultCode of the operation
+     */
+    ResultCode ControlArchive(ArchiveHandle handle, u32 action);
+
     /**
      * Open a File from an Archive
      * @param archive_handle Handle to an open Archive object
@@ -228,9 +237,17 @@ public:
     /// Registers a new NCCH file with the SelfNCCH archive factory
     void RegisterSelfNCCH(Loader::ProgramLoader& program_loader);
 
+    /// Returns the worker pool that performs host file reads off the CPU thread
+    Common::ThreadPool& GetIOPool() {
+        return io_pool;
+    }
+
 private:
     Core::System& system;
 
+    /// Host reads are I/O bound, a couple of workers are enough to overlap them
+    Common::ThreadPool io_pool{2};
+
     /**
      * Registers an Archive type, instances of which can later be opened using its IDCode.
      * @param factory File system backend interface to the archive
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
@@ -11,10 +12,16 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/file.h"
 
 namespace Service::FS {
 
+File::~File() {
+    // The I/O worker may still be reading into the backend
+    WaitForPendingRead();
+}
+
 File::File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
            const FileSys::Path& path)
     : ServiceFramework{"", 1}, path{path}, backend{std::move(backend)}, system{system} {
@@ -50,25 +57,80 @@ void File::Read(Kernel::HLERequestContext& ctx) {
         LOG_ERROR(Service_FS,
                   "Reading from out of bounds offset=0x{:X} length=0x{:08X} file_size=0x{:X}",
                   offset, length, backend->GetSize());
-    auto rb{rp.MakeBuilder(2, 2)};
-    std::vector<u8> data(length);
-    ResultVal<std::size_t> read{backend->Read(offset, data.size(), data.data())};
-    if (read.Failed()) {
-        rb.Push(read.Code());
-        rb.Push<u32>(0);
-    } else {
-        buffer.Write(data.data(), 0, *read);
-        rb.Push(RESULT_SUCCESS);
-        rb.Push<u32>(static_cast<u32>(*read));
+    WaitForPendingRead();
+    const std::size_t read_length{std::min<std::size_t>(length, buffer.GetSize())};
+    auto spans{buffer.GetWriteSpans(0, read_length)};
+    // The client thread must always be woken up by the timeout
+    const std::chrono::nanoseconds read_timeout_ns{
+        std::max<u64>(backend->GetReadDelayNs(length), 1)};
+    const bool in_place{std::all_of(spans.begin(), spans.end(),
+                                    [](const Memory::MemorySpan& span) { return span.pointer; })};
+    if (!in_place) {
+        // Part of the buffer isn't backed by plain memory, read on this thread
+        auto [result, total_read]{ReadSpans(*backend, offset, spans, &buffer)};
+        auto rb{rp.MakeBuilder(2, 2)};
+        rb.Push(result);
+        rb.Push<u32>(result.IsError() ? 0 : static_cast<u32>(total_read));
+        rb.PushMappedBuffer(buffer);
+        ctx.SleepClientThread(system.Kernel().GetThreadManager().GetCurrentThread(), "file::read",
+                              read_timeout_ns,
+                              [](Kernel::SharedPtr<Kernel::Thread> thread,
+                                 Kernel::HLERequestContext& ctx,
+                                 Kernel::ThreadWakeupReason reason) {
+                                  // Nothing to do here
+                              });
+        return;
     }
-    rb.PushMappedBuffer(buffer);
-    std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
-    ctx.SleepClientThread(system.Kernel().GetThreadManager().GetCurrentThread(), "file::read",
-                          read_timeout_ns,
-                          [](Kernel::SharedPtr<Kernel::Thread> thread,
-                             Kernel::HLERequestContext& ctx, Kernel::ThreadWakeupReason reason) {
-                              // Nothing to do here
-                          });
+    // Do the host read on an I/O worker while the client thread sleeps for the emulated read
+    // delay. The response is built once both have finished. The spans point at the host view of
+    // protected pages, so the worker never faults on guest memory or touches the rasterizer.
+    auto pending{std::make_shared<std::pair<ResultCode, std::size_t>>(RESULT_SUCCESS, 0)};
+    pending_read = system.ArchiveManager()
+                       .GetIOPool()
+                       .Push([backend = backend.get(), offset, spans = std::move(spans), pending] {
+                           *pending = ReadSpans(*backend, offset, spans, nullptr);
+                       })
+                       .share();
+    ctx.SleepClientThread(
+        system.Kernel().GetThreadManager().GetCurrentThread(), "file::read", read_timeout_ns,
+        [pending, done = pending_read, buffer = buffer](Kernel::SharedPtr<Kernel::Thread> thread,
+                                                        Kernel::HLERequestContext& ctx,
+                                                        Kernel::ThreadWakeupReason reason) {
+            done.wait();
+            const auto& [result, total_read]{*pending};
+            IPC::ResponseBuilder rb{ctx, 0x0802, 2, 2};
+            rb.Push(result);
+            rb.Push<u32>(result.IsError() ? 0 : static_cast<u32>(total_read));
+            rb.PushMappedBuffer(buffer);
+        });
+}
+
+std::pair<ResultCode, std::size_t> File::ReadSpans(FileSys::FileBackend& backend, u64 offset,
+                                                   const Memory::MemorySpans& spans,
+                                                   Kernel::MappedBuffer* buffer) {
+    std::size_t total_read{};
+    for (const auto& span : spans) {
+        ResultVal<std::size_t> read;
+        if (span.pointer)
+            read = backend.Read(offset + total_read, span.size, span.pointer);
+        else {
+            std::vector<u8> data(span.size);
+            read = backend.Read(offset + total_read, data.size(), data.data());
+            if (read.Succeeded())
+                buffer->Write(data.data(), total_read, *read);
+        }
+        if (read.Failed())
+            return {read.Code(), 0};
+        total_read += *read;
+        if (*read < span.size)
+            break;
+    }
+    return {RESULT_SUCCESS, total_read};
+}
+
+void File::WaitForPendingRead() {
+    if (pending_read.valid())
+        pending_read.wait();
 }
 
 void File::Write(Kernel::HLERequestContext& ctx) {
@@ -79,6 +141,7 @@ void File::Write(Kernel::HLERequestContext& ctx) {
     auto& buffer{rp.PopMappedBuffer()};
     LOG_TRACE(Service_FS, "Write {}: offset=0x{:X}, length={}, flush=0x{:x}", GetName(), offset,
               length, flush);
+    WaitForPendingRead();
     auto rb{rp.MakeBuilder(2, 2)};
     const FileSessionSlot* file{GetSessionData(ctx.Session())};
     // Subfiles can't be written to
@@ -88,15 +151,38 @@ void File::Write(Kernel::HLERequestContext& ctx) {
         rb.PushMappedBuffer(buffer);
         return;
     }
-    std::vector<u8> data(length);
-    buffer.Read(data.data(), 0, data.size());
-    ResultVal<std::size_t> written{backend->Write(offset, data.size(), flush != 0, data.data())};
-    if (written.Failed()) {
-        rb.Push(written.Code());
+    // Write straight from the guest memory backing the buffer
+    ResultCode result{RESULT_SUCCESS};
+    std::size_t total_written{};
+    const auto spans{buffer.GetReadSpans(0, length)};
+    for (const auto& span : spans) {
+        // Only flush the file once everything has been written
+        const bool flush_span{flush != 0 && &span == &spans.back()};
+        ResultVal<std::size_t> written;
+        if (span.pointer)
+            written = backend->Write(offset + total_written, span.size, flush_span, span.pointer);
+        else {
+            std::vector<u8> data(span.size);
+            buffer.Read(data.data(), total_written, data.size());
+            written = backend->Write(offset + total_written, data.size(), flush_span, data.data());
+        }
+        if (written.Failed()) {
+            result = written.Code();
+            break;
+        }
+        total_written += *written;
+        if (*written < span.size)
+            break;
+    }
+    // An empty write can still request a flush
+    if (spans.empty() && flush != 0)
+        backend->Flush();
+    if (result.IsError()) {
+        rb.Push(result);
         rb.Push<u32>(0);
     } else {
         rb.Push(RESULT_SUCCESS);
-        rb.Push<u32>(static_cast<u32>(*written));
+        rb.Push<u32>(static_cast<u32>(total_written));
     }
     rb.PushMappedBuffer(buffer);
 }
@@ -118,6 +204,7 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
         rb.Push(FileSys::ERROR_UNSUPPORTED_OPEN_FLAGS);
         return;
     }
+    WaitForPendingRead();
     file->size = size;
     backend->SetSize(size);
     rb.Push(RESULT_SUCCESS);
@@ -128,6 +215,7 @@ void File::Close(Kernel::HLERequestContext& ctx) {
     if (connected_sessions.size() > 1)
         LOG_WARNING(Service_FS, "Closing File backend but {} clients still connected",
                     connected_sessions.size());
+    WaitForPendingRead();
     backend->Close();
     IPC::ResponseBuilder rb{ctx, 0x0808, 1, 0};
     rb.Push(RESULT_SUCCESS);
@@ -141,6 +229,7 @@ void File::Flush(Kernel::HLERequestContext& ctx) {
         rb.Push(FileSys::ERROR_UNSUPPORTED_OPEN_FLAGS);
         return;
     }
+    WaitForPendingRead();
     backend->Flush();
     rb.Push(RESULT_SUCCESS);
 }
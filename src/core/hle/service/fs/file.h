@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <future>
+#include <utility>
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/service/service.h"
@@ -27,7 +29,7 @@ class File final : public ServiceFramework<File, FileSessionSlot> {
 public:
     File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
          const FileSys::Path& path);
-    ~File() = default;
+    ~File();
 
     std::string GetName() const {
         return "Path: " + path.DebugStr();
@@ -59,7 +61,23 @@ private:
     void OpenLinkFile(Kernel::HLERequestContext& ctx);
     void OpenSubFile(Kernel::HLERequestContext& ctx);
 
+    /**
+     * Reads from the backend into the given spans, stopping at the first short read.
+     * @param buffer Used to write the spans that aren't backed by plain memory, can be null when
+     * there are none
+     * @return The result of the read and the amount of bytes read
+     */
+    static std::pair<ResultCode, std::size_t> ReadSpans(FileSys::FileBackend& backend, u64 offset,
+                                                        const Memory::MemorySpans& spans,
+                                                        Kernel::MappedBuffer* buffer);
+
+    /// Blocks until the read running on the I/O worker, if any, has finished with the backend
+    void WaitForPendingRead();
+
     Core::System& system;
+
+    /// Read of this file currently running on the I/O worker
+    std::shared_future<void> pending_read;
 };
 
 } // namespace Service::FS
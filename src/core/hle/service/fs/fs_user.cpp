@@ -298,6 +298,22 @@ void FS_USER::OpenArchive(Kernel::HLERequestContext& ctx) {
     }
 }
 
+void FS_USER::ControlArchive(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx, 0x80D, 5, 4};
+    auto archive_handle{rp.PopRaw<ArchiveHandle>()};
+    u32 action{rp.Pop<u32>()};
+    u32 input_size{rp.Pop<u32>()};
+    u32 output_size{rp.Pop<u32>()};
+    auto& input{rp.PopMappedBuffer()};
+    auto& output{rp.PopMappedBuffer()};
+    LOG_DEBUG(Service_FS, "action={}, input_size={}, output_size={}", action, input_size,
+              output_size);
+    auto rb{rp.MakeBuilder(1, 4)};
+    rb.Push(archives.ControlArchive(archive_handle, action));
+    rb.PushMappedBuffer(input);
+    rb.PushMappedBuffer(output);
+}
+
 void FS_USER::CloseArchive(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp{ctx, 0x80E, 2, 0};
     auto archive_handle{rp.PopRaw<ArchiveHandle>()};
@@ -817,7 +833,7 @@ FS_USER::FS_USER(Core::System& system)
         {0x080A0244, &FS_USER::RenameDirectory, "RenameDirectory"},
         {0x080B0102, &FS_USER::OpenDirectory, "OpenDirectory"},
         {0x080C00C2, &FS_USER::OpenArchive, "OpenArchive"},
-        {0x080D0144, nullptr, "ControlArchive"},
+        {0x080D0144, &FS_USER::ControlArchive, "ControlArchive"},
         {0x080E0080, &FS_USER::CloseArchive, "CloseArchive"},
         {0x080F0180, &FS_USER::FormatThisUserSaveData, "FormatThisUserSaveData"},
         {0x08100200, &FS_USER::CreateLegacySystemSaveData, "CreateLegacySystemSaveData"},
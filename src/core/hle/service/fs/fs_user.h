@@ -53,6 +53,7 @@ private:
     void RenameDirectory(Kernel::HLERequestContext& ctx);
     void OpenDirectory(Kernel::HLERequestContext& ctx);
     void OpenArchive(Kernel::HLERequestContext& ctx);
+    void ControlArchive(Kernel::HLERequestContext& ctx);
     void CloseArchive(Kernel::HLERequestContext& ctx);
     void IsSdmcDetected(Kernel::HLERequestContext& ctx);
     void IsSdmcWriteable(Kernel::HLERequestContext& ctx);
@@ -391,7 +391,7 @@ Module::Interface::Interface(std::shared_ptr<Module> nfc, const char* name)
 Module::Interface::~Interface() = default;
 
 void Module::Interface::LoadAmiibo(AmiiboData data, std::string path) {
-    std::lock_guard lock{HLE::g_hle_lock};
+    HLE::HLELockGuard lock{"NFC::LoadAmiibo"};
     LOG_INFO(Service_NFC, "Loading amiibo {}", path);
     nfc->encrypted_data = data;
     nfc->decrypted_data.fill(0);
@@ -401,7 +401,7 @@ void Module::Interface::LoadAmiibo(AmiiboData data, std::string path) {
 }
 
 void Module::Interface::RemoveAmiibo() {
-    std::lock_guard lock{HLE::g_hle_lock};
+    HLE::HLELockGuard lock{"NFC::RemoveAmiibo"};
     LOG_INFO(Service_NFC, "Removing amiibo");
     nfc->encrypted_data.fill(0);
     nfc->decrypted_data.fill(0);
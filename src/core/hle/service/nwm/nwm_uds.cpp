@@ -172,9 +172,8 @@ void NWM_UDS::HandleAssociationResponseFrame(const Network::WifiPacket& packet)
 }
 
 void NWM_UDS::HandleEAPoLPacket(const Network::WifiPacket& packet) {
-    std::unique_lock hle_lock{HLE::g_hle_lock, std::defer_lock};
-    std::unique_lock lock{connection_status_mutex, std::defer_lock};
-    std::lock(hle_lock, lock);
+    HLE::HLELockGuard hle_lock{"NWM_UDS::HandleEAPoLPacket"};
+    std::lock_guard lock{connection_status_mutex};
     if (GetEAPoLFrameType(packet.data) == EAPoLStartMagic) {
         if (connection_status.status != static_cast<u32>(NetworkStatus::ConnectedAsHost)) {
             LOG_DEBUG(Service_NWM, "Connection sequence aborted, because connection status is {}",
@@ -270,9 +269,8 @@ void NWM_UDS::HandleEAPoLPacket(const Network::WifiPacket& packet) {
 
 void NWM_UDS::HandleSecureDataPacket(const Network::WifiPacket& packet) {
     auto secure_data{ParseSecureDataHeader(packet.data)};
-    std::unique_lock hle_lock{HLE::g_hle_lock, std::defer_lock};
-    std::unique_lock lock{connection_status_mutex, std::defer_lock};
-    std::lock(hle_lock, lock);
+    HLE::HLELockGuard hle_lock{"NWM_UDS::HandleSecureDataPacket"};
+    std::lock_guard lock{connection_status_mutex};
     if (connection_status.status != static_cast<u32>(NetworkStatus::ConnectedAsHost) &&
         connection_status.status != static_cast<u32>(NetworkStatus::ConnectedAsClient)) {
         // TODO: Handle spectators
@@ -406,9 +404,8 @@ void NWM_UDS::HandleAuthenticationFrame(const Network::WifiPacket& packet) {
 
 /// Handles the deauthentication frames sent from clients to hosts, when they leave a session
 void NWM_UDS::HandleDeauthenticationFrame(const Network::WifiPacket& packet) {
-    std::unique_lock hle_lock{HLE::g_hle_lock, std::defer_lock};
-    std::unique_lock lock{connection_status_mutex, std::defer_lock};
-    std::lock(hle_lock, lock);
+    HLE::HLELockGuard hle_lock{"NWM_UDS::HandleDeauthenticationFrame"};
+    std::lock_guard lock{connection_status_mutex};
     if (connection_status.status != static_cast<u32>(NetworkStatus::ConnectedAsHost)) {
         LOG_ERROR(Service_NWM, "Got deauthentication frame but we'ren't the host");
         return;
@@ -872,6 +869,8 @@ void NWM_UDS::SendTo(Kernel::HLERequestContext& ctx) {
     packet.channel = network_channel;
     packet.data = std::move(data_payload);
     packet.type = Network::WifiPacket::PacketType::Data;
+    // Data frames of programs may get lost on real Wi-Fi too, the connection frames may not
+    packet.reliable = false;
     SendPacket(packet);
     rb.Push(RESULT_SUCCESS);
 }
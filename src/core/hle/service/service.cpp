@@ -125,6 +125,9 @@ const std::array<ServiceModuleInfo, 38> service_module_map{
     return function_string;
 }
 
+/// Highest command ID (exclusive) that is looked up through the handler table
+constexpr u32 MAX_HANDLER_TABLE_SIZE{0x1000};
+
 ServiceFrameworkBase::ServiceFrameworkBase(const char* service_name, u32 max_sessions,
                                            InvokerFn* handler_invoker)
     : service_name{service_name}, max_sessions{max_sessions}, handler_invoker{handler_invoker} {}
@@ -149,6 +152,29 @@ void ServiceFrameworkBase::RegisterHandlersBase(const FunctionInfoBase* function
     for (std::size_t i{}; i < n; ++i)
         // Usually this array is sorted by id already, so hint to insert at the end
         handlers.emplace_hint(handlers.cend(), functions[i].expected_header, functions[i]);
+    // Inserting into the map invalidates the pointers to its elements, so rebuild the table
+    handler_table.clear();
+    for (const auto& [header, info] : handlers) {
+        const u32 command_id{header >> 16};
+        if (command_id >= MAX_HANDLER_TABLE_SIZE)
+            continue;
+        if (command_id >= handler_table.size())
+            handler_table.resize(command_id + 1);
+        if (!handler_table[command_id])
+            handler_table[command_id] = &info;
+    }
+}
+
+const ServiceFrameworkBase::FunctionInfoBase* ServiceFrameworkBase::FindHandler(
+    u32 header_code) const {
+    const u32 command_id{header_code >> 16};
+    if (command_id < handler_table.size()) {
+        const auto info{handler_table[command_id]};
+        if (info && info->expected_header == header_code)
+            return info;
+    }
+    auto itr{handlers.find(header_code)};
+    return itr == handlers.end() ? nullptr : &itr->second;
 }
 
 void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const FunctionInfoBase* info) {
@@ -163,25 +189,32 @@ void ServiceFrameworkBase::HandleSyncRequest(SharedPtr<ServerSession> server_ses
     // TODO: avoid GetPointer
     u32* cmd_buf{reinterpret_cast<u32*>(
         server_session->system.Memory().GetPointer(thread->GetCommandBufferAddress()))};
-    u32 header_code{cmd_buf[0]};
-    auto itr{handlers.find(header_code)};
-    const auto info{itr == handlers.end() ? nullptr : &itr->second};
+    const auto info{FindHandler(cmd_buf[0])};
     if (!info || !info->handler_callback)
         return ReportUnimplementedFunction(cmd_buf, info);
     auto current_process{kernel.GetCurrentProcess()};
+    std::unique_ptr<Kernel::HLERequestContext> context;
+    if (free_contexts.empty()) {
+        context = std::make_unique<Kernel::HLERequestContext>(std::move(server_session));
+    } else {
+        context = std::move(free_contexts.back());
+        free_contexts.pop_back();
+        context->Reset(std::move(server_session));
+    }
     // TODO: The kernel should be the one handling this as part of translation after
     // everything else is migrated
-    Kernel::HLERequestContext context{std::move(server_session)};
-    context.PopulateFromIncomingCommandBuffer(cmd_buf, *current_process);
+    context->PopulateFromIncomingCommandBuffer(cmd_buf, *current_process);
     LOG_TRACE(Service, "{}", MakeFunctionString(info->name, GetServiceName().c_str(), cmd_buf));
-    handler_invoker(this, info->handler_callback, context);
+    handler_invoker(this, info->handler_callback, *context);
     ASSERT(thread->status == Kernel::ThreadStatus::Running ||
            thread->status == Kernel::ThreadStatus::WaitHleEvent);
     // Only write the response immediately if the thread is still running. If the HLE handler put
     // the thread to sleep then the writing of the command buffer will be deferred to the wakeup
-    // callback.
+    // callback, which works on its own copy of the context.
     if (thread->status == Kernel::ThreadStatus::Running)
-        context.WriteToOutgoingCommandBuffer(cmd_buf, *current_process);
+        context->WriteToOutgoingCommandBuffer(cmd_buf, *current_process);
+    context->Reset(nullptr);
+    free_contexts.push_back(std::move(context));
 }
 
 static bool AttemptLLE(Core::System& system, const ServiceModuleInfo& service_module) {
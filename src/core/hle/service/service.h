@@ -7,7 +7,9 @@
 #include <array>
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 #include <boost/container/flat_map.hpp>
 #include "common/common_types.h"
 #include "core/hle/kernel/hle_ipc.h"
@@ -90,6 +92,9 @@ private:
     void RegisterHandlersBase(const FunctionInfoBase* functions, std::size_t n);
     void ReportUnimplementedFunction(u32* cmd_buf, const FunctionInfoBase* info);
 
+    /// Returns the handler for a request header, or nullptr if there is none.
+    const FunctionInfoBase* FindHandler(u32 header_code) const;
+
     /// Identifier string used to connect to the service.
     std::string service_name;
 
@@ -105,6 +110,15 @@ private:
     /// Function used to safely up-cast pointers to the derived class before invoking a handler.
     InvokerFn* handler_invoker;
     boost::container::flat_map<u32, FunctionInfoBase> handlers;
+
+    /**
+     * Handlers indexed by command ID, for looking up requests without a search. The header still
+     * has to be compared, since several handlers can share a command ID.
+     */
+    std::vector<const FunctionInfoBase*> handler_table;
+
+    /// Request contexts that can be reused, so that handling a request doesn't allocate.
+    std::vector<std::unique_ptr<Kernel::HLERequestContext>> free_contexts;
 };
 
 /**
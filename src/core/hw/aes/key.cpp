@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <exception>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <cryptopp/aes.h>
@@ -81,6 +82,8 @@ struct KeySlot {
     }
 };
 
+// Keys are read by the program list threads as well as the emulation thread
+std::mutex key_mutex;
 std::array<KeySlot, KeySlotID::MaxKeySlotID> key_slots;
 std::array<std::optional<AESKey>, 6> common_key_y_slots;
 
@@ -218,6 +221,7 @@ void LoadPresetKeys() {
 } // namespace
 
 void InitKeys() {
+    std::lock_guard lock{key_mutex};
     static bool initialized{};
     if (initialized)
         return;
@@ -227,26 +231,39 @@ void InitKeys() {
 }
 
 void SetKeyX(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard lock{key_mutex};
     key_slots.at(slot_id).SetKeyX(key);
 }
 
 void SetKeyY(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard lock{key_mutex};
     key_slots.at(slot_id).SetKeyY(key);
 }
 
 void SetNormalKey(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard lock{key_mutex};
     key_slots.at(slot_id).SetNormalKey(key);
 }
 
 bool IsNormalKeyAvailable(std::size_t slot_id) {
+    std::lock_guard lock{key_mutex};
     return key_slots.at(slot_id).normal.has_value();
 }
 
 AESKey GetNormalKey(std::size_t slot_id) {
+    std::lock_guard lock{key_mutex};
     return key_slots.at(slot_id).normal.value_or(AESKey{});
 }
 
+std::optional<AESKey> GenerateNormalKey(std::size_t slot_id, const AESKey& key_y) {
+    std::lock_guard lock{key_mutex};
+    KeySlot slot{key_slots.at(slot_id)};
+    slot.SetKeyY(key_y);
+    return slot.normal;
+}
+
 void SelectCommonKeyIndex(u8 index) {
+    std::lock_guard lock{key_mutex};
     key_slots[KeySlotID::TicketCommonKey].SetKeyY(common_key_y_slots.at(index));
 }
 
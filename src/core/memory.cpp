@@ -2,11 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <optional>
 #include "audio_core/hle/hle.h"
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/host_memory.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
 #include "core/core.h"
@@ -15,6 +18,7 @@
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
 #include "core/memory.h"
+#include "core/settings.h"
 #include "video_core/renderer/renderer.h"
 #include "video_core/video_core.h"
 
@@ -51,28 +55,174 @@ private:
     std::array<bool, NEW_LINEAR_HEAP_SIZE / PAGE_SIZE> new_linear_heap{};
 };
 
+/**
+ * Tracks the rasterizer cache state of FCRAM and VRAM pages when page protection is enabled.
+ * Instead of marking cached pages as RasterizerCachedMemory, which sends every access through the
+ * slow path, the guest view of the backing is protected: read-only for pages with clean surfaces
+ * and no-access for pages with surfaces not yet flushed. The first access that faults flushes or
+ * invalidates the page and lifts the protection.
+ */
+class RasterizerPageProtection {
+public:
+    RasterizerPageProtection() : fcram{FCRAM_N3DS_SIZE}, vram{VRAM_N3DS_SIZE} {}
+
+    bool IsValid() const {
+        return fcram.IsValid() && vram.IsValid() && Common::GetHostPageSize() == PAGE_SIZE;
+    }
+
+    u8* FCRAMHostView() const {
+        return fcram.HostView();
+    }
+
+    u8* VRAMHostView() const {
+        return vram.HostView();
+    }
+
+    /// Translates a pointer into the host view of the backing to the guest view
+    u8* ToGuestView(u8* pointer) const {
+        for (const auto* backing : {&fcram, &vram})
+            if (pointer >= backing->HostView() &&
+                pointer < backing->HostView() + backing->Size())
+                return backing->GuestView() + (pointer - backing->HostView());
+        return pointer;
+    }
+
+    /// Translates a pointer into the guest view of the backing to the host view
+    u8* ToHostView(u8* pointer) const {
+        for (const auto* backing : {&fcram, &vram})
+            if (pointer >= backing->GuestView() &&
+                pointer < backing->GuestView() + backing->Size())
+                return backing->HostView() + (pointer - backing->GuestView());
+        return pointer;
+    }
+
+    /// Translates a pointer into the guest view of the backing to a physical address
+    std::optional<PAddr> ToPhysicalAddress(const u8* pointer) const {
+        if (pointer >= fcram.GuestView() && pointer < fcram.GuestView() + fcram.Size())
+            return FCRAM_PADDR + static_cast<PAddr>(pointer - fcram.GuestView());
+        if (pointer >= vram.GuestView() && pointer < vram.GuestView() + vram.Size())
+            return VRAM_PADDR + static_cast<PAddr>(pointer - vram.GuestView());
+        return {};
+    }
+
+    void MarkCached(PAddr page_addr, bool cached) {
+        auto page{At(page_addr)};
+        if (!page)
+            return;
+        page->cached = cached;
+        if (!cached)
+            Protect(page_addr, *page, Common::MemoryPermission::ReadWrite);
+        else if (page->permission == Common::MemoryPermission::ReadWrite)
+            Protect(page_addr, *page, Common::MemoryPermission::Read);
+    }
+
+    void MarkDirty(PAddr page_addr) {
+        auto page{At(page_addr)};
+        if (page && page->cached)
+            Protect(page_addr, *page, Common::MemoryPermission::None);
+    }
+
+    void MarkLoaded(PAddr page_addr) {
+        auto page{At(page_addr)};
+        if (page && page->cached && page->permission == Common::MemoryPermission::ReadWrite)
+            Protect(page_addr, *page, Common::MemoryPermission::Read);
+    }
+
+    Common::MemoryPermission GetPermission(PAddr page_addr) {
+        auto page{At(page_addr)};
+        return page ? page->permission : Common::MemoryPermission::ReadWrite;
+    }
+
+    void SetPermission(PAddr page_addr, Common::MemoryPermission permission) {
+        auto page{At(page_addr)};
+        if (page)
+            Protect(page_addr, *page, permission);
+    }
+
+private:
+    struct PageState {
+        bool cached{};
+        Common::MemoryPermission permission{Common::MemoryPermission::ReadWrite};
+    };
+
+    PageState* At(PAddr addr) {
+        if (addr >= VRAM_PADDR && addr < VRAM_N3DS_PADDR_END)
+            return &vram_pages[(addr - VRAM_PADDR) / PAGE_SIZE];
+        else if (addr >= FCRAM_PADDR && addr < FCRAM_N3DS_PADDR_END)
+            return &fcram_pages[(addr - FCRAM_PADDR) / PAGE_SIZE];
+        return nullptr;
+    }
+
+    void Protect(PAddr page_addr, PageState& page, Common::MemoryPermission permission) {
+        if (page.permission == permission)
+            return;
+        page.permission = permission;
+        if (page_addr >= VRAM_PADDR && page_addr < VRAM_N3DS_PADDR_END)
+            vram.Protect(page_addr - VRAM_PADDR, PAGE_SIZE, permission);
+        else
+            fcram.Protect(page_addr - FCRAM_PADDR, PAGE_SIZE, permission);
+    }
+
+    Common::HostMemory fcram;
+    Common::HostMemory vram;
+    std::array<PageState, FCRAM_N3DS_SIZE / PAGE_SIZE> fcram_pages{};
+    std::array<PageState, VRAM_N3DS_SIZE / PAGE_SIZE> vram_pages{};
+};
+
 struct MemorySystem::Impl {
     explicit Impl(Core::System& system) : system{system} {
-        std::fill(fcram.get(), fcram.get() + FCRAM_N3DS_SIZE, 0);
-        std::fill(vram.get(), vram.get() + VRAM_N3DS_SIZE, 0);
+        if (Settings::values.use_page_protection) {
+            page_protection = std::make_unique<RasterizerPageProtection>();
+            if (page_protection->IsValid()) {
+                fcram = page_protection->FCRAMHostView();
+                vram = page_protection->VRAMHostView();
+            } else {
+                LOG_ERROR(HW_Memory, "Page protection unavailable, falling back to page checks");
+                page_protection.reset();
+            }
+        }
+        if (!page_protection) {
+            fcram_storage = std::make_unique<u8[]>(FCRAM_N3DS_SIZE);
+            vram_storage = std::make_unique<u8[]>(VRAM_N3DS_SIZE);
+            fcram = fcram_storage.get();
+            vram = vram_storage.get();
+        }
+        std::fill(fcram, fcram + FCRAM_N3DS_SIZE, 0);
+        std::fill(vram, vram + VRAM_N3DS_SIZE, 0);
         std::fill(n3ds_extra_ram.get(), n3ds_extra_ram.get() + N3DS_EXTRA_RAM_SIZE, 0);
         std::fill(l2cache.get(), l2cache.get() + L2C_SIZE, 0);
     }
 
+    ~Impl() {
+        if (page_protection)
+            Common::SetAccessFaultHandler({});
+    }
+
     // Visual Studio would try to allocate these on compile time if they are std::array, which would
     // exceed the memory limit.
-    std::unique_ptr<u8[]> fcram{std::make_unique<u8[]>(FCRAM_N3DS_SIZE)};
-    std::unique_ptr<u8[]> vram{std::make_unique<u8[]>(VRAM_N3DS_SIZE)};
+    std::unique_ptr<u8[]> fcram_storage;
+    std::unique_ptr<u8[]> vram_storage;
     std::unique_ptr<u8[]> n3ds_extra_ram{std::make_unique<u8[]>(N3DS_EXTRA_RAM_SIZE)};
     std::unique_ptr<u8[]> l2cache{std::make_unique<u8[]>(L2C_SIZE)};
 
+    // Host views of FCRAM and VRAM, backed by either the storage above or the page protection
+    // mappings
+    u8* fcram{};
+    u8* vram{};
+
     PageTable* current_page_table{};
     RasterizerCacheMarker cache_marker;
+    std::unique_ptr<RasterizerPageProtection> page_protection;
     std::vector<PageTable*> page_table_list;
     Core::System& system;
 };
 
-MemorySystem::MemorySystem(Core::System& system) : impl{std::make_unique<Impl>(system)} {}
+MemorySystem::MemorySystem(Core::System& system) : impl{std::make_unique<Impl>(system)} {
+    if (impl->page_protection)
+        Common::SetAccessFaultHandler(
+            [this](void* fault_address) { return HandleAccessFault(fault_address); });
+}
+
 MemorySystem::~MemorySystem() = default;
 
 void MemorySystem::SetCurrentPageTable(PageTable* page_table) {
@@ -90,19 +240,28 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, u8* memor
               (base + size) * PAGE_SIZE);
     RasterizerFlushVirtualRegion(base << PAGE_BITS, size * PAGE_SIZE,
                                  FlushMode::FlushAndInvalidate);
-    u32 end{base + size};
-    while (base != end) {
-        ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}", base);
-        page_table.attributes[base] = type;
-        page_table.pointers[base] = memory;
-        base += 1;
-        // If the memory to map is already rasterizer-cached, mark the page
-        if (type == PageType::Memory && impl->cache_marker.IsCached(base * PAGE_SIZE)) {
-            page_table.attributes[base] = PageType::RasterizerCachedMemory;
-            page_table.pointers[base] = nullptr;
+    // With page protection, the CPU accesses FCRAM and VRAM through the protected guest view and
+    // the pages never need to be marked as cached
+    const bool page_protection{impl->page_protection != nullptr};
+    if (page_protection && memory)
+        memory = impl->page_protection->ToGuestView(memory);
+    const u32 end{base + size};
+    ASSERT_MSG(end <= PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}", base);
+    std::fill(page_table.attributes.begin() + base, page_table.attributes.begin() + end, type);
+    if (memory) {
+        for (u32 page{base}; page != end; ++page, memory += PAGE_SIZE)
+            page_table.pointers[page] = memory;
+    } else {
+        std::fill(page_table.pointers.begin() + base, page_table.pointers.begin() + end, nullptr);
+    }
+    if (page_protection || type != PageType::Memory)
+        return;
+    // If the memory to map is already rasterizer-cached, mark the page
+    for (u32 page{base}; page != end; ++page) {
+        if (impl->cache_marker.IsCached(page * PAGE_SIZE)) {
+            page_table.attributes[page] = PageType::RasterizerCachedMemory;
+            page_table.pointers[page] = nullptr;
         }
-        if (memory)
-            memory += PAGE_SIZE;
     }
 }
 
@@ -134,11 +293,11 @@ void MemorySystem::UnmapRegion(PageTable& page_table, VAddr base, u32 size) {
  */
 u8* MemorySystem::GetPointerForRasterizerCache(VAddr addr) {
     if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END)
-        return impl->fcram.get() + (addr - LINEAR_HEAP_VADDR);
+        return impl->fcram + (addr - LINEAR_HEAP_VADDR);
     else if (addr >= NEW_LINEAR_HEAP_VADDR && addr < NEW_LINEAR_HEAP_VADDR_END)
-        return impl->fcram.get() + (addr - NEW_LINEAR_HEAP_VADDR);
+        return impl->fcram + (addr - NEW_LINEAR_HEAP_VADDR);
     else if (addr >= VRAM_VADDR && addr < VRAM_N3DS_VADDR_END)
-        return impl->vram.get() + (addr - VRAM_VADDR);
+        return impl->vram + (addr - VRAM_VADDR);
     UNREACHABLE();
 }
 
@@ -174,7 +333,7 @@ T MemorySystem::Read(const VAddr vaddr) {
     }
     // The memory access might do an MMIO or cached access, so we have to lock the HLE kernel
     // state
-    std::lock_guard lock{HLE::g_hle_lock};
+    HLE::HLELockGuard lock{"MemorySystem::Read"};
     auto type{impl->current_page_table->attributes[vaddr >> PAGE_BITS]};
     switch (type) {
     case PageType::Unmapped:
@@ -209,7 +368,7 @@ void MemorySystem::Write(const VAddr vaddr, const T data) {
     }
     // The memory access might do an MMIO or cached access, so we have to lock the HLE kernel
     // state
-    std::lock_guard lock{HLE::g_hle_lock};
+    HLE::HLELockGuard lock{"MemorySystem::Write"};
     PageType type{impl->current_page_table->attributes[vaddr >> PAGE_BITS]};
     switch (type) {
     case PageType::Unmapped:
@@ -300,13 +459,13 @@ u8* MemorySystem::GetPhysicalPointer(PAddr address) {
     u8* target_pointer;
     switch (area->paddr_base) {
     case VRAM_PADDR:
-        target_pointer = impl->vram.get() + offset_into_region;
+        target_pointer = impl->vram + offset_into_region;
         break;
     case DSP_RAM_PADDR:
         target_pointer = impl->system.DSP().GetDspMemory().data() + offset_into_region;
         break;
     case FCRAM_PADDR:
-        target_pointer = impl->fcram.get() + offset_into_region;
+        target_pointer = impl->fcram + offset_into_region;
         break;
     case N3DS_EXTRA_RAM_PADDR:
         target_pointer = impl->n3ds_extra_ram.get() + offset_into_region;
@@ -341,6 +500,11 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
         return;
     u32 num_pages{((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1};
     auto paddr{start};
+    if (impl->page_protection) {
+        for (unsigned i{}; i < num_pages; ++i, paddr += PAGE_SIZE)
+            impl->page_protection->MarkCached(paddr & ~PAGE_MASK, cached);
+        return;
+    }
     for (unsigned i{}; i < num_pages; ++i, paddr += PAGE_SIZE) {
         for (const auto& vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
             impl->cache_marker.Mark(vaddr, cached);
@@ -372,6 +536,68 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
     }
 }
 
+void MemorySystem::RasterizerMarkRegionDirty(PAddr start, u32 size) {
+    if (!impl->page_protection || size == 0)
+        return;
+    for (PAddr paddr{start & ~PAGE_MASK}; paddr < start + size; paddr += PAGE_SIZE)
+        impl->page_protection->MarkDirty(paddr);
+}
+
+void MemorySystem::RasterizerMarkRegionLoaded(PAddr start, u32 size) {
+    if (!impl->page_protection || size == 0)
+        return;
+    for (PAddr paddr{start & ~PAGE_MASK}; paddr < start + size; paddr += PAGE_SIZE)
+        impl->page_protection->MarkLoaded(paddr);
+}
+
+bool MemorySystem::HandleAccessFault(void* fault_address) {
+    const auto paddr{impl->page_protection->ToPhysicalAddress(static_cast<u8*>(fault_address))};
+    if (!paddr)
+        return false;
+    const PAddr page_addr{*paddr & ~PAGE_MASK};
+    // The fault might come from the CPU thread or a host thread accessing guest memory, the
+    // rasterizer cache is protected by the HLE lock in both cases
+    HLE::HLELockGuard lock{"MemorySystem::HandleAccessFault"};
+    switch (impl->page_protection->GetPermission(page_addr)) {
+    case Common::MemoryPermission::None:
+        // The page holds data not yet written back by the rasterizer. Flush it and leave the page
+        // read-only, a write will fault again and invalidate it.
+        RasterizerFlushRegion(page_addr, PAGE_SIZE);
+        impl->page_protection->SetPermission(page_addr, Common::MemoryPermission::Read);
+        return true;
+    case Common::MemoryPermission::Read:
+        // Write to a page holding clean surfaces. They stay unprotected until they're reloaded.
+        RasterizerInvalidateRegion(page_addr, PAGE_SIZE);
+        impl->page_protection->SetPermission(page_addr, Common::MemoryPermission::ReadWrite);
+        return true;
+    case Common::MemoryPermission::ReadWrite:
+        // Another thread lifted the protection before we acquired the lock
+        return true;
+    }
+    return false;
+}
+
+u8* MemorySystem::ResolveProtectedSpan(u8* pointer, std::size_t size, FlushMode mode) {
+    const auto paddr{impl->page_protection->ToPhysicalAddress(pointer)};
+    if (!paddr)
+        return pointer;
+    HLE::HLELockGuard lock{"MemorySystem::ResolveProtectedSpan"};
+    for (PAddr page_addr{*paddr & ~PAGE_MASK}; page_addr < *paddr + size; page_addr += PAGE_SIZE) {
+        auto permission{impl->page_protection->GetPermission(page_addr)};
+        if (permission == Common::MemoryPermission::None) {
+            // Also needed before writing, the span might only cover part of the page
+            RasterizerFlushRegion(page_addr, PAGE_SIZE);
+            permission = Common::MemoryPermission::Read;
+        }
+        if (permission == Common::MemoryPermission::Read && mode != FlushMode::Flush) {
+            RasterizerInvalidateRegion(page_addr, PAGE_SIZE);
+            permission = Common::MemoryPermission::ReadWrite;
+        }
+        impl->page_protection->SetPermission(page_addr, permission);
+    }
+    return impl->page_protection->ToHostView(pointer);
+}
+
 void MemorySystem::RasterizerFlushRegion(PAddr start, u32 size) {
     if (!VideoCore::g_renderer)
         return;
@@ -440,46 +666,72 @@ u64 MemorySystem::Read64(const VAddr addr) {
     return Read<u64_le>(addr);
 }
 
-void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_addr,
-                             void* dest_buffer, const std::size_t size) {
+MemorySpans MemorySystem::GetBlockSpans(const Kernel::Process& process, const VAddr addr,
+                                        const std::size_t size, FlushMode mode) {
     auto& page_table{process.vm_manager.page_table};
+    MemorySpans spans;
     std::size_t remaining_size{size};
-    std::size_t page_index{src_addr >> PAGE_BITS};
-    std::size_t page_offset{src_addr & PAGE_MASK};
+    std::size_t page_index{addr >> PAGE_BITS};
+    std::size_t page_offset{addr & PAGE_MASK};
     while (remaining_size > 0) {
-        const std::size_t copy_amount{std::min(PAGE_SIZE - page_offset, remaining_size)};
+        const std::size_t span_amount{std::min(PAGE_SIZE - page_offset, remaining_size)};
         const VAddr current_vaddr{static_cast<VAddr>((page_index << PAGE_BITS) + page_offset)};
-        switch (page_table.attributes[page_index]) {
+        const PageType type{page_table.attributes[page_index]};
+        u8* pointer{};
+        switch (type) {
         case PageType::Unmapped:
-            LOG_ERROR(HW_Memory,
-                      "unmapped ReadBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
-                      current_vaddr, src_addr, size);
-            std::memset(dest_buffer, 0, copy_amount);
+        case PageType::Special:
             break;
-        case PageType::Memory: {
+        case PageType::Memory:
             DEBUG_ASSERT(page_table.pointers[page_index]);
-            const u8* src_ptr{page_table.pointers[page_index] + page_offset};
-            std::memcpy(dest_buffer, src_ptr, copy_amount);
+            pointer = page_table.pointers[page_index] + page_offset;
             break;
-        }
-        case PageType::Special: {
-            auto handler{GetMMIOHandler(page_table, current_vaddr)};
-            DEBUG_ASSERT(handler);
-            handler->ReadBlock(current_vaddr, dest_buffer, copy_amount);
-            break;
-        }
         case PageType::RasterizerCachedMemory:
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
-            std::memcpy(dest_buffer, GetPointerForRasterizerCache(current_vaddr), copy_amount);
+            pointer = GetPointerForRasterizerCache(current_vaddr);
             break;
         default:
             UNREACHABLE();
         }
+        // IO regions are kept page by page as each page might have a different handler
+        if (!spans.empty() && type != PageType::Special && spans.back().type == type &&
+            (!pointer || spans.back().pointer + spans.back().size == pointer))
+            spans.back().size += static_cast<u32>(span_amount);
+        else
+            spans.push_back({current_vaddr, pointer, static_cast<u32>(span_amount), type});
         page_index++;
         page_offset = 0;
-        dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-        remaining_size -= copy_amount;
+        remaining_size -= span_amount;
+    }
+    for (auto& span : spans)
+        if (span.type == PageType::RasterizerCachedMemory)
+            RasterizerFlushVirtualRegion(span.vaddr, span.size, mode);
+        else if (impl->page_protection && span.pointer)
+            span.pointer = ResolveProtectedSpan(span.pointer, span.size, mode);
+    return spans;
+}
+
+void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_addr,
+                             void* dest_buffer, const std::size_t size) {
+    auto& page_table{process.vm_manager.page_table};
+    for (const auto& span : GetBlockSpans(process, src_addr, size, FlushMode::Flush)) {
+        switch (span.type) {
+        case PageType::Unmapped:
+            LOG_ERROR(HW_Memory,
+                      "unmapped ReadBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
+                      span.vaddr, src_addr, size);
+            std::memset(dest_buffer, 0, span.size);
+            break;
+        case PageType::Special: {
+            auto handler{GetMMIOHandler(page_table, span.vaddr)};
+            DEBUG_ASSERT(handler);
+            handler->ReadBlock(span.vaddr, dest_buffer, span.size);
+            break;
+        }
+        default:
+            std::memcpy(dest_buffer, span.pointer, span.size);
+            break;
+        }
+        dest_buffer = static_cast<u8*>(dest_buffer) + span.size;
     }
 }
 
@@ -502,183 +754,81 @@ void MemorySystem::Write64(const VAddr addr, const u64 data) {
 void MemorySystem::WriteBlock(const Kernel::Process& process, const VAddr dest_addr,
                               const void* src_buffer, const std::size_t size) {
     auto& page_table{process.vm_manager.page_table};
-    std::size_t remaining_size{size};
-    std::size_t page_index{dest_addr >> PAGE_BITS};
-    std::size_t page_offset{dest_addr & PAGE_MASK};
-    while (remaining_size > 0) {
-        const std::size_t copy_amount{std::min(PAGE_SIZE - page_offset, remaining_size)};
-        const VAddr current_vaddr{static_cast<VAddr>((page_index << PAGE_BITS) + page_offset)};
-        switch (page_table.attributes[page_index]) {
+    for (const auto& span : GetBlockSpans(process, dest_addr, size, FlushMode::Invalidate)) {
+        switch (span.type) {
         case PageType::Unmapped:
             LOG_ERROR(HW_Memory,
                       "unmapped WriteBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
-                      current_vaddr, dest_addr, size);
+                      span.vaddr, dest_addr, size);
             break;
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-            u8* dest_ptr{page_table.pointers[page_index] + page_offset};
-            std::memcpy(dest_ptr, src_buffer, copy_amount);
-            break;
-        }
         case PageType::Special: {
-            MMIORegionPointer handler{GetMMIOHandler(page_table, current_vaddr)};
+            MMIORegionPointer handler{GetMMIOHandler(page_table, span.vaddr)};
             DEBUG_ASSERT(handler);
-            handler->WriteBlock(current_vaddr, src_buffer, copy_amount);
+            handler->WriteBlock(span.vaddr, src_buffer, span.size);
             break;
         }
-        case PageType::RasterizerCachedMemory:
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Invalidate);
-            std::memcpy(GetPointerForRasterizerCache(current_vaddr), src_buffer, copy_amount);
-            break;
         default:
-            UNREACHABLE();
+            std::memcpy(span.pointer, src_buffer, span.size);
+            break;
         }
-        page_index++;
-        page_offset = 0;
-        src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-        remaining_size -= copy_amount;
+        src_buffer = static_cast<const u8*>(src_buffer) + span.size;
     }
 }
 
 void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_addr,
                              const std::size_t size) {
     auto& page_table{process.vm_manager.page_table};
-    std::size_t remaining_size{size};
-    std::size_t page_index{dest_addr >> PAGE_BITS};
-    std::size_t page_offset{dest_addr & PAGE_MASK};
     static const std::array<u8, PAGE_SIZE> zeros = {};
-    while (remaining_size > 0) {
-        const std::size_t copy_amount{std::min(PAGE_SIZE - page_offset, remaining_size)};
-        const VAddr current_vaddr{static_cast<VAddr>((page_index << PAGE_BITS) + page_offset)};
-        switch (page_table.attributes[page_index]) {
+    for (const auto& span : GetBlockSpans(process, dest_addr, size, FlushMode::Invalidate)) {
+        switch (span.type) {
         case PageType::Unmapped:
             LOG_ERROR(HW_Memory,
                       "unmapped ZeroBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
-                      current_vaddr, dest_addr, size);
+                      span.vaddr, dest_addr, size);
             break;
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-            u8* dest_ptr{page_table.pointers[page_index] + page_offset};
-            std::memset(dest_ptr, 0, copy_amount);
-            break;
-        }
         case PageType::Special: {
-            MMIORegionPointer handler{GetMMIOHandler(page_table, current_vaddr)};
+            MMIORegionPointer handler{GetMMIOHandler(page_table, span.vaddr)};
             DEBUG_ASSERT(handler);
-            handler->WriteBlock(current_vaddr, zeros.data(), copy_amount);
+            handler->WriteBlock(span.vaddr, zeros.data(), span.size);
             break;
         }
-        case PageType::RasterizerCachedMemory:
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Invalidate);
-            std::memset(GetPointerForRasterizerCache(current_vaddr), 0, copy_amount);
-            break;
         default:
-            UNREACHABLE();
+            std::memset(span.pointer, 0, span.size);
+            break;
         }
-        page_index++;
-        page_offset = 0;
-        remaining_size -= copy_amount;
     }
 }
 
 void MemorySystem::CopyBlock(const Kernel::Process& process, VAddr dest_addr, VAddr src_addr,
                              const std::size_t size) {
-    auto& page_table{process.vm_manager.page_table};
-    std::size_t remaining_size{size};
-    std::size_t page_index{src_addr >> PAGE_BITS};
-    std::size_t page_offset{src_addr & PAGE_MASK};
-    while (remaining_size > 0) {
-        const std::size_t copy_amount{std::min(PAGE_SIZE - page_offset, remaining_size)};
-        const VAddr current_vaddr{static_cast<VAddr>((page_index << PAGE_BITS) + page_offset)};
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "unmapped CopyBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
-                      current_vaddr, src_addr, size);
-            ZeroBlock(process, dest_addr, copy_amount);
-            break;
-        }
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-            const u8* src_ptr{page_table.pointers[page_index] + page_offset};
-            WriteBlock(process, dest_addr, src_ptr, copy_amount);
-            break;
-        }
-        case PageType::Special: {
-            auto handler{GetMMIOHandler(page_table, current_vaddr)};
-            DEBUG_ASSERT(handler);
-            std::vector<u8> buffer(copy_amount);
-            handler->ReadBlock(current_vaddr, buffer.data(), buffer.size());
-            WriteBlock(process, dest_addr, buffer.data(), buffer.size());
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
-            WriteBlock(process, dest_addr, GetPointerForRasterizerCache(current_vaddr),
-                       copy_amount);
-            break;
-        }
-        default:
-            UNREACHABLE();
-        }
-        page_index++;
-        page_offset = 0;
-        dest_addr += static_cast<VAddr>(copy_amount);
-        src_addr += static_cast<VAddr>(copy_amount);
-        remaining_size -= copy_amount;
-    }
+    CopyBlock(process, process, src_addr, dest_addr, size);
 }
 
 void MemorySystem::CopyBlock(const Kernel::Process& src_process,
                              const Kernel::Process& dest_process, VAddr src_addr, VAddr dest_addr,
                              std::size_t size) {
     auto& page_table{src_process.vm_manager.page_table};
-    std::size_t remaining_size{size};
-    std::size_t page_index{src_addr >> PAGE_BITS};
-    std::size_t page_offset{src_addr & PAGE_MASK};
-    while (remaining_size > 0) {
-        const std::size_t copy_amount{std::min(PAGE_SIZE - page_offset, remaining_size)};
-        const VAddr current_vaddr{static_cast<VAddr>((page_index << PAGE_BITS) + page_offset)};
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
+    for (const auto& span : GetBlockSpans(src_process, src_addr, size, FlushMode::Flush)) {
+        switch (span.type) {
+        case PageType::Unmapped:
             LOG_ERROR(HW_Memory,
                       "unmapped CopyBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
-                      current_vaddr, src_addr, size);
-            ZeroBlock(dest_process, dest_addr, copy_amount);
+                      span.vaddr, src_addr, size);
+            ZeroBlock(dest_process, dest_addr, span.size);
             break;
-        }
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-            const u8* src_ptr{page_table.pointers[page_index] + page_offset};
-            WriteBlock(dest_process, dest_addr, src_ptr, copy_amount);
-            break;
-        }
         case PageType::Special: {
-            MMIORegionPointer handler{GetMMIOHandler(page_table, current_vaddr)};
+            MMIORegionPointer handler{GetMMIOHandler(page_table, span.vaddr)};
             DEBUG_ASSERT(handler);
-            std::vector<u8> buffer(copy_amount);
-            handler->ReadBlock(current_vaddr, buffer.data(), buffer.size());
-            WriteBlock(dest_process, dest_addr, buffer.data(), buffer.size());
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
-            WriteBlock(dest_process, dest_addr, GetPointerForRasterizerCache(current_vaddr),
-                       copy_amount);
+            std::array<u8, PAGE_SIZE> buffer;
+            handler->ReadBlock(span.vaddr, buffer.data(), span.size);
+            WriteBlock(dest_process, dest_addr, buffer.data(), span.size);
             break;
         }
         default:
-            UNREACHABLE();
+            WriteBlock(dest_process, dest_addr, span.pointer, span.size);
+            break;
         }
-        page_index++;
-        page_offset = 0;
-        dest_addr += static_cast<VAddr>(copy_amount);
-        src_addr += static_cast<VAddr>(copy_amount);
-        remaining_size -= copy_amount;
+        dest_addr += span.size;
     }
 }
 
@@ -723,13 +873,13 @@ void WriteMMIO<u64>(MMIORegionPointer mmio_handler, VAddr addr, const u64 data)
 }
 
 u32 MemorySystem::GetFCRAMOffset(u8* pointer) {
-    ASSERT(pointer >= impl->fcram.get() && pointer < impl->fcram.get() + FCRAM_N3DS_SIZE);
-    return pointer - impl->fcram.get();
+    ASSERT(pointer >= impl->fcram && pointer < impl->fcram + FCRAM_N3DS_SIZE);
+    return pointer - impl->fcram;
 }
 
 u8* MemorySystem::GetFCRAMPointer(u32 offset) {
     ASSERT(offset <= FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram + offset;
 }
 
 } // namespace Memory
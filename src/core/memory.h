@@ -6,8 +6,10 @@
 
 #include <array>
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
+#include <boost/container/small_vector.hpp>
 #include "common/common_types.h"
 #include "core/mmio.h"
 
@@ -45,6 +47,17 @@ enum class PageType {
     Special,
 };
 
+/// A contiguous part of a guest virtual address range with uniform backing
+struct MemorySpan {
+    VAddr vaddr;
+    /// Host memory backing the span. This is null for unmapped spans and IO regions.
+    u8* pointer;
+    u32 size;
+    PageType type;
+};
+
+using MemorySpans = boost::container::small_vector<MemorySpan, 4>;
+
 struct SpecialRegion {
     VAddr base;
     u32 size;
@@ -255,6 +268,16 @@ public:
     void CopyBlock(const Kernel::Process& src_process, const Kernel::Process& dest_process,
                    VAddr src_addr, VAddr dest_addr, std::size_t size);
 
+    /**
+     * Gets the host memory backing a region of the process address space as a list of contiguous
+     * spans, so that it can be accessed in place. Spans of rasterizer cached memory are flushed or
+     * invalidated according to `mode` before returning, once per span. With page protection, the
+     * pages are unprotected as needed and the spans point at the host view, so they can be passed
+     * to other threads and system calls without faulting.
+     */
+    MemorySpans GetBlockSpans(const Kernel::Process& process, VAddr addr, std::size_t size,
+                              FlushMode mode);
+
     u8* GetPointer(VAddr vaddr);
 
     std::string ReadCString(VAddr vaddr, std::size_t max_length);
@@ -265,6 +288,12 @@ public:
     /// Mark each page touching the region as cached.
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /// Marks each page touching the region as holding rasterizer data not written back to RAM.
+    void RasterizerMarkRegionDirty(PAddr start, u32 size);
+
+    /// Marks each page touching the region as reloaded into the rasterizer cache from RAM.
+    void RasterizerMarkRegionLoaded(PAddr start, u32 size);
+
     /// Flushes any externally cached rasterizer resources touching the given region.
     void RasterizerFlushRegion(PAddr start, u32 size);
 
@@ -310,6 +339,18 @@ private:
 
     void MapPages(PageTable& page_table, u32 base, u32 size, u8* memory, PageType type);
 
+    /**
+     * Resolves an access fault on a protected FCRAM or VRAM page by flushing or invalidating the
+     * rasterizer cache. Returns false if the address doesn't belong to the protected backing.
+     */
+    bool HandleAccessFault(void* fault_address);
+
+    /**
+     * Prepares the protected pages backing a span for an access through the host view, the same
+     * way an access fault would, and returns the host view pointer for the span.
+     */
+    u8* ResolveProtectedSpan(u8* pointer, std::size_t size, FlushMode mode);
+
     struct Impl;
     std::unique_ptr<Impl> impl;
 };
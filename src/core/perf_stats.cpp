@@ -36,6 +36,13 @@ void PerfStats::EndAppFrame() {
     program_frames += 1;
 }
 
+void PerfStats::AddAudioBufferSample(microseconds buffered, bool underrun) {
+    audio_buffer_us += static_cast<u64>(buffered.count());
+    ++audio_buffer_samples;
+    if (underrun)
+        ++audio_underruns;
+}
+
 PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_us) {
     std::lock_guard lock{object_mutex};
     const auto now{Clock::now()};
@@ -48,6 +55,11 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    const u32 buffer_samples{audio_buffer_samples.exchange(0)};
+    const u64 buffer_us{audio_buffer_us.exchange(0)};
+    results.audio_buffer_fill =
+        buffer_samples ? static_cast<double>(buffer_us) / buffer_samples / 1'000'000.0 : 0.0;
+    results.audio_underruns = audio_underruns.exchange(0);
     // Reset counters
     reset_point = now;
     reset_point_system_us = current_system_time_us;
@@ -32,12 +32,21 @@ public:
 
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+
+        /// Average fill level of the audio output buffer, in seconds
+        double audio_buffer_fill;
+
+        /// Number of audio output blocks that ran out of samples
+        u32 audio_underruns;
     };
 
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndAppFrame();
 
+    /// Records the fill level of the audio output buffer, called by the audio thread once per block
+    void AddAudioBufferSample(std::chrono::microseconds buffered, bool underrun);
+
     Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
     /**
@@ -72,6 +81,11 @@ private:
 
     /// Total visible duration (including frame-limiting, etc.) of the previous system frame
     Clock::duration previous_frame_length{Clock::duration::zero()};
+
+    /// Audio statistics since last reset, atomic so that the audio thread doesn't have to lock
+    std::atomic<u64> audio_buffer_us{};
+    std::atomic<u32> audio_buffer_samples{};
+    std::atomic<u32> audio_underruns{};
 };
 
 class FrameLimiter {
@@ -68,6 +68,7 @@ void LogSettings() {
     LogSetting("Graphics_ShadersAccurateGs", values.shaders_accurate_gs);
     LogSetting("Graphics_ShadersAccurateMul", values.shaders_accurate_mul);
     LogSetting("Graphics_EnableCacheClear", values.enable_cache_clear);
+    LogSetting("Graphics_UsePageProtection", values.use_page_protection);
     LogSetting("Layout_LayoutOption", static_cast<int>(values.layout_option));
     LogSetting("Layout_SwapScreens", values.swap_screens);
     bool using_lle_modules{};
@@ -81,6 +82,9 @@ void LogSettings() {
     LogSetting("Lle_UseLleDsp", values.use_lle_dsp);
     LogSetting("Lle_EnableLleDspMultithread", Settings::values.enable_lle_dsp_multithread);
     LogSetting("Audio_EnableAudioStretching", values.enable_audio_stretching);
+    LogSetting("Audio_EnableParallelAudioSources", values.enable_parallel_audio_sources);
+    LogSetting("Audio_EnableLowLatencyAudio", values.enable_low_latency_audio);
+    LogSetting("Audio_Latency", values.audio_latency);
     LogSetting("Audio_OutputDevice", values.output_device);
     using namespace Service::CAM;
     LogSetting("Camera_OuterRightName", values.camera_name[OuterRightCamera]);
@@ -93,7 +97,10 @@ void LogSettings() {
     LogSetting("Camera_OuterLeftConfig", values.camera_config[OuterLeftCamera]);
     LogSetting("Camera_OuterLeftFlip", values.camera_flip[OuterLeftCamera]);
     LogSetting("DataStorage_UseVirtualSd", values.use_virtual_sd);
+    LogSetting("DataStorage_UseTitleCache", values.use_title_cache);
+    LogSetting("DataStorage_UseSaveWriteBack", values.use_save_write_back);
     LogSetting("System_RegionValue", values.region_value);
+    LogSetting("Miscellaneous_RecordHleLockStats", values.record_hle_lock_stats);
     LogSetting("Hacks_PriorityBoost", values.priority_boost);
     LogSetting("Hacks_Ticks", values.ticks);
     LogSetting("Hacks_TicksMode", static_cast<int>(values.ticks_mode));
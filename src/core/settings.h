@@ -146,6 +146,8 @@ struct Values {
 
     // Data Storage
     bool use_virtual_sd;
+    bool use_title_cache;
+    bool use_save_write_back;
     std::string nand_dir;
     std::string sdmc_dir;
 
@@ -165,6 +167,7 @@ struct Values {
     float screen_refresh_rate;
     int min_vertices_per_thread;
     bool enable_cache_clear;
+    bool use_page_protection;
 
     LayoutOption layout_option;
     bool swap_screens;
@@ -184,9 +187,13 @@ struct Values {
 
     // Logging
     std::string log_filter;
+    bool record_hle_lock_stats;
 
     // Audio
     bool enable_audio_stretching;
+    bool enable_parallel_audio_sources;
+    bool enable_low_latency_audio;
+    u16 audio_latency; ///< Target output buffer fill in milliseconds, for low latency audio
     std::string output_device;
 
     // Camera
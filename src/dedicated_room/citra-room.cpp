@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
@@ -15,13 +16,16 @@
 #include "common/scm_rev.h"
 #include "common/string_util.h"
 #include "network/room.h"
+#include "network/room_server.h"
 
 static void PrintHelp(const char* argv0) {
     std::cout << "Usage: " << argv0
               << " [options] <filename>\n"
                  "-room-name        The name of the room\n"
                  "-room-description The room description\n"
-                 "-port             The port used for the room\n"
+                 "-port             The port used for the room, or the first room\n"
+                 "-rooms            The number of rooms to host on consecutive ports\n"
+                 "-threads          The number of threads handling the rooms, 0 for one per CPU\n"
                  "-max-members      The maximum number of members for this room\n"
                  "-announce!        Create a public room\n"
                  "-password         The password for the room\n"
@@ -65,6 +69,15 @@ static void SaveBanList(const Network::Room::BanList& ban_list, const std::strin
     file.flush();
 }
 
+static void PrintRelayStats(const Network::Room& room) {
+    const auto stats{room.GetRelayStats()};
+    std::cout << fmt::format("{}: relayed {} Wi-Fi packets as {} packets ({} bytes), dropped {}, "
+                             "handled {} events in {} ms\n",
+                             room.GetRoomInformation().name, stats.packets_received,
+                             stats.packets_sent, stats.bytes_sent, stats.packets_dropped,
+                             stats.events_handled, stats.busy_time_us / 1000);
+}
+
 /// Application entry point
 int main(int argc, char** argv) {
     asl::CmdArgs args{argc, argv};
@@ -72,6 +85,8 @@ int main(int argc, char** argv) {
     std::string room_description{static_cast<const char*>(args["room-description"])};
     u32 port{static_cast<u32>(args("port", asl::String{Network::DefaultRoomPort}).toInt())};
     u32 max_members{static_cast<u32>(args("max-members", "16").toInt())};
+    const int rooms_arg{args("rooms", "1").toInt()};
+    const int threads_arg{args("threads", "0").toInt()};
     std::string password{static_cast<const char*>(args["password"])};
     std::string creator{static_cast<const char*>(args["creator"])};
     std::string ban_list_file{static_cast<const char*>(args["ban-list-file"])};
@@ -89,11 +104,25 @@ int main(int argc, char** argv) {
         PrintHelp(argv[0]);
         return -1;
     }
-    if (port == 0 || port > 65535) {
-        std::cout << "Port needs to be in the range 1 - 65535!\n\n";
+    if (rooms_arg <= 0) {
+        std::cout << "Number of rooms needs to be at least 1!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    if (threads_arg < 0) {
+        std::cout << "Number of threads can't be negative!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    const u32 num_rooms{static_cast<u32>(rooms_arg)};
+    u32 num_threads{static_cast<u32>(threads_arg)};
+    if (port == 0 || port + num_rooms - 1 > 65535) {
+        std::cout << "Ports need to be in the range 1 - 65535!\n\n";
         PrintHelp(argv[0]);
         return -1;
     }
+    if (num_threads == 0)
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
     if (creator.empty()) {
         std::cout << "Creator is empty!\n\n";
         PrintHelp(argv[0]);
@@ -110,35 +139,42 @@ int main(int argc, char** argv) {
         std::cout << "Error when initializing ENet\n\n";
         return -1;
     }
-    Network::Room room;
-    room.SetErrorCallback([&announce](const Common::WebResult& result) {
+    Network::RoomServer server{std::min(num_threads, num_rooms)};
+    server.SetBanList(std::move(ban_list));
+    server.SetErrorCallback([&announce](const Common::WebResult& result) {
         if (result.result_code != Common::WebResult::Code::Success)
             announce = false;
         std::cout << result.result_string << std::endl;
     });
-    if (!room.Create(announce, room_name, room_description, creator, port, password, max_members,
-                     ban_list)) {
-        std::cout << "Failed to create room!\n\n";
-        return -1;
+    for (u32 i{}; i < num_rooms; ++i) {
+        const std::string name{num_rooms == 1 ? room_name : fmt::format("{} {}", room_name, i + 1)};
+        if (!server.CreateRoom(announce, name, room_description, creator,
+                               static_cast<u16>(port + i), password, max_members)) {
+            std::cout << fmt::format("Failed to create room on port {}!\n\n", port + i);
+            return -1;
+        }
     }
-    std::cout << fmt::format("Hosting a {} room\nRoom is open. Close with Q+Enter...\n\n",
-                             announce ? "public" : "private");
-    while (room.IsOpen()) {
+    std::cout << fmt::format("Hosting {} {} room(s)\nRooms are open. Close with Q+Enter...\n\n",
+                             num_rooms, announce ? "public" : "private");
+    const auto AnyRoomOpen{[&server] {
+        const auto rooms{server.GetRooms()};
+        return std::any_of(rooms.begin(), rooms.end(),
+                           [](const Network::Room* room) { return room->IsOpen(); });
+    }};
+    while (AnyRoomOpen()) {
         std::string in;
         std::cin >> in;
-        if (in.size() > 0) {
-            // Save the ban list
-            if (!ban_list_file.empty())
-                SaveBanList(room.GetBanList(), ban_list_file);
-            room.Destroy();
-            return 0;
-        }
+        if (in.size() > 0)
+            break;
         std::this_thread::sleep_for(std::chrono::milliseconds{100});
     }
     // Save the ban list
     if (!ban_list_file.empty())
-        SaveBanList(room.GetBanList(), ban_list_file);
-    room.Destroy();
+        SaveBanList(server.GetBanList(), ban_list_file);
+    for (Network::Room* room : server.GetRooms()) {
+        PrintRelayStats(*room);
+        server.CloseRoom(room);
+    }
     enet_deinitialize();
     return 0;
 }
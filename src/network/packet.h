@@ -5,11 +5,17 @@
 #pragma once
 
 #include <array>
+#include <type_traits>
 #include <vector>
 #include "common/common_types.h"
 
 namespace Network {
 
+/// Whether containers of T are (de)serialized by copying their bytes as a whole
+template <typename T>
+constexpr bool is_packet_byte_v{std::is_same_v<T, u8> || std::is_same_v<T, s8> ||
+                                std::is_same_v<T, char>};
+
 /// A class that serializes data for network transfer. It also handles endianess
 class Packet {
 public:
@@ -120,25 +126,38 @@ private:
 template <typename T>
 Packet& Packet::operator>>(std::vector<T>& out_data) {
     // First extract the size
-    u32 size;
+    u32 size{};
     *this >> size;
-    out_data.resize(size);
     // Then extract the data
-    for (std::size_t i{}; i < out_data.size(); ++i) {
-        T character;
-        *this >> character;
-        out_data[i] = character;
+    if constexpr (is_packet_byte_v<T>) {
+        // Check the size before resizing, so that a bogus size can't allocate lots of memory
+        if (!CheckSize(size)) {
+            out_data.clear();
+            return *this;
+        }
+        out_data.resize(size);
+        Read(out_data.data(), size);
+    } else {
+        out_data.resize(size);
+        for (std::size_t i{}; i < out_data.size(); ++i) {
+            T character;
+            *this >> character;
+            out_data[i] = character;
+        }
     }
     return *this;
 }
 
 template <typename T, std::size_t S>
 Packet& Packet::operator>>(std::array<T, S>& out_data) {
-    for (std::size_t i{}; i < out_data.size(); ++i) {
-        T character;
-        *this >> character;
-        out_data[i] = character;
-    }
+    if constexpr (is_packet_byte_v<T>)
+        Read(out_data.data(), S);
+    else
+        for (std::size_t i{}; i < out_data.size(); ++i) {
+            T character;
+            *this >> character;
+            out_data[i] = character;
+        }
     return *this;
 }
 
@@ -148,17 +167,23 @@ Packet& Packet::operator<<(const std::vector<T>& in_data) {
     *this << static_cast<u32>(in_data.size());
 
     // Then insert the data
-    for (std::size_t i{}; i < in_data.size(); ++i) {
-        *this << in_data[i];
-    }
+    if constexpr (is_packet_byte_v<T>)
+        Append(in_data.data(), in_data.size());
+    else
+        for (std::size_t i{}; i < in_data.size(); ++i) {
+            *this << in_data[i];
+        }
     return *this;
 }
 
 template <typename T, std::size_t S>
 Packet& Packet::operator<<(const std::array<T, S>& in_data) {
-    for (std::size_t i{}; i < in_data.size(); ++i) {
-        *this << in_data[i];
-    }
+    if constexpr (is_packet_byte_v<T>)
+        Append(in_data.data(), S);
+    else
+        for (std::size_t i{}; i < in_data.size(); ++i) {
+            *this << in_data[i];
+        }
     return *this;
 }
 
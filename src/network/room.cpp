@@ -4,17 +4,21 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstring>
 #include <iomanip>
 #include <mutex>
 #include <random>
 #include <regex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
 #include <utility>
 #include <asl/Http.h>
 #include <asl/HttpServer.h>
 #include <asl/JSON.h>
 #include <enet/enet.h>
+#include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/thread_pool.h"
 #include "network/packet.h"
@@ -59,6 +63,14 @@ public:
     }
 };
 
+struct MacAddressHash {
+    std::size_t operator()(const MacAddress& address) const {
+        u64 value{};
+        std::memcpy(&value, address.data(), address.size());
+        return std::hash<u64>{}(value);
+    }
+};
+
 struct Room::RoomImpl {
     RoomImpl() : random_gen{std::random_device{}()} {}
 
@@ -87,8 +99,21 @@ struct Room::RoomImpl {
     MemberList members;              ///< Information about the members of this room
     mutable std::mutex member_mutex; ///< Mutex for locking the members list
 
-    BanList ban_list;                  ///< List of banned IP addresses
-    mutable std::mutex ban_list_mutex; ///< Mutex for locking the ban list
+    /// Peer of each member by MAC address. Only used by the server thread, so it isn't locked.
+    std::unordered_map<MacAddress, ENetPeer*, MacAddressHash> peers_by_mac;
+
+    struct {
+        std::atomic<u64> packets_received{};
+        std::atomic<u64> packets_sent{};
+        std::atomic<u64> bytes_sent{};
+        std::atomic<u64> packets_dropped{};
+        std::atomic<u64> events_handled{};
+        std::atomic<u64> busy_time_us{};
+    } relay_stats;
+
+    /// List of banned IP addresses
+    std::shared_ptr<SharedBanList> ban_list{std::make_shared<SharedBanList>()};
+    bool shares_ban_list{};
 
     std::unique_ptr<std::thread>
         room_thread; ///< Thread that receives and dispatches network packets
@@ -97,6 +122,15 @@ struct Room::RoomImpl {
                        ///< is destroyed.
     void StartLoop();
 
+    /// Waits up to timeout_ms for an event, then handles all pending events and sends the replies
+    void HandleEvents(u32 timeout_ms);
+
+    /// Dispatches a received ENet event
+    void HandleEvent(const ENetEvent* event);
+
+    /// Removes the member from the members list and the MAC index, member_mutex must be held
+    void EraseMember(MemberList::iterator member);
+
     /**
      * Parses and answers a room join request from a client.
      * Validates the uniqueness of the nickname and assigns the MAC address
@@ -217,7 +251,9 @@ struct Room::RoomImpl {
     MacAddress GenerateMacAddress();
 
     /**
-     * Broadcasts this packet to all members except the sender.
+     * Forwards this packet to its destination member, or to all members except the sender if it's
+     * a broadcast. The received ENet packet is sent as is instead of being copied, so the caller
+     * must only destroy it if it wasn't queued to any peer.
      * @param event The ENet event containing the data
      */
     void HandleWifiPacket(const ENetEvent* event);
@@ -252,55 +288,83 @@ struct Room::RoomImpl {
 void Room::RoomImpl::ServerLoop() {
     while (is_open.load(std::memory_order_relaxed)) {
         ENetEvent event;
-        if (enet_host_service(server, &event, 50) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdJoinRequest:
-                    HandleJoinRequest(&event);
-                    break;
-                case IdSetProgram:
-                    HandleProgramPacket(&event);
-                    break;
-                case IdWifiPacket:
-                    HandleWifiPacket(&event);
-                    break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
-                    break;
-                // Moderation
-                case IdModKick:
-                    HandleModKickPacket(&event);
-                    break;
-                case IdModBan:
-                    HandleModBanPacket(&event);
-                    break;
-                case IdModUnban:
-                    HandleModUnbanPacket(&event);
-                    break;
-                case IdModGetBanList:
-                    HandleModGetBanListPacket(&event);
-                    break;
-                }
-                enet_packet_destroy(event.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                HandleClientDisconnection(event.peer);
-                break;
-            case ENET_EVENT_TYPE_NONE:
-            case ENET_EVENT_TYPE_CONNECT:
-                break;
-            }
-        }
+        HandleEvents(50);
     }
     // Close the connection to all members:
     SendCloseMessage();
 }
 
+void Room::RoomImpl::HandleEvents(u32 timeout_ms) {
+    ENetEvent event;
+    if (enet_host_service(server, &event, timeout_ms) <= 0)
+        return;
+    const auto start{std::chrono::steady_clock::now()};
+    u64 num_events{};
+    // Handle every event that arrived with this one before sending the queued packets, so that
+    // relayed packets go out in as few datagrams as possible
+    do {
+        HandleEvent(&event);
+        ++num_events;
+    } while (enet_host_check_events(server, &event) > 0);
+    enet_host_flush(server);
+    const auto busy_time{std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start)};
+    relay_stats.events_handled.fetch_add(num_events, std::memory_order_relaxed);
+    relay_stats.busy_time_us.fetch_add(busy_time.count(), std::memory_order_relaxed);
+}
+
+void Room::RoomImpl::HandleEvent(const ENetEvent* event) {
+    switch (event->type) {
+    case ENET_EVENT_TYPE_RECEIVE:
+        switch (event->packet->data[0]) {
+        case IdJoinRequest:
+            HandleJoinRequest(event);
+            break;
+        case IdSetProgram:
+            HandleProgramPacket(event);
+            break;
+        case IdWifiPacket:
+            HandleWifiPacket(event);
+            break;
+        case IdChatMessage:
+            HandleChatPacket(event);
+            break;
+        // Moderation
+        case IdModKick:
+            HandleModKickPacket(event);
+            break;
+        case IdModBan:
+            HandleModBanPacket(event);
+            break;
+        case IdModUnban:
+            HandleModUnbanPacket(event);
+            break;
+        case IdModGetBanList:
+            HandleModGetBanListPacket(event);
+            break;
+        }
+        // Relayed packets are freed by ENet once every peer is done with them
+        if (event->packet->referenceCount == 0)
+            enet_packet_destroy(event->packet);
+        break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+        HandleClientDisconnection(event->peer);
+        break;
+    case ENET_EVENT_TYPE_NONE:
+    case ENET_EVENT_TYPE_CONNECT:
+        break;
+    }
+}
+
 void Room::RoomImpl::StartLoop() {
     room_thread = std::make_unique<std::thread>(&Room::RoomImpl::ServerLoop, this);
 }
 
+void Room::RoomImpl::EraseMember(MemberList::iterator member) {
+    peers_by_mac.erase(member->mac_address);
+    members.erase(member);
+}
+
 void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     {
         std::lock_guard lock{member_mutex};
@@ -354,12 +418,13 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     member.nickname = nickname;
     member.peer = event->peer;
     {
-        std::lock_guard lock{ban_list_mutex};
+        std::lock_guard lock{ban_list->mutex};
         // Check IP ban
         char ip_raw[256];
         enet_address_get_host_ip(&event->peer->address, ip_raw, sizeof(ip_raw) - 1);
         std::string ip{ip_raw};
-        if (std::find(ban_list.begin(), ban_list.end(), ip) != ban_list.end()) {
+        auto& addresses{ban_list->addresses};
+        if (std::find(addresses.begin(), addresses.end(), ip) != addresses.end()) {
             SendUserBanned(event->peer);
             return;
         }
@@ -368,6 +433,7 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     SendStatusMessage(IdMemberJoined, member.nickname);
     {
         std::lock_guard lock{member_mutex};
+        peers_by_mac.emplace(member.mac_address, member.peer);
         members.emplace_back(std::move(member));
     }
     // Notify everyone that the room information has changed.
@@ -397,7 +463,7 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
         // Notify the kicked member
         SendUserKicked(target_member->peer);
         enet_peer_disconnect(target_member->peer, 0);
-        members.erase(target_member);
+        EraseMember(target_member);
     }
     // Announce the change to all clients.
     SendStatusMessage(IdMemberKicked, nickname);
@@ -431,13 +497,14 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
         enet_address_get_host_ip(&target_member->peer->address, ip_raw, 256);
         ip = ip_raw;
         enet_peer_disconnect(target_member->peer, 0);
-        members.erase(target_member);
+        EraseMember(target_member);
     }
     {
-        std::lock_guard lock{ban_list_mutex};
+        std::lock_guard lock{ban_list->mutex};
         // Ban the member's IP
-        if (std::find(ban_list.begin(), ban_list.end(), ip) == ban_list.end())
-            ban_list.emplace_back(std::move(ip));
+        auto& addresses{ban_list->addresses};
+        if (std::find(addresses.begin(), addresses.end(), ip) == addresses.end())
+            addresses.emplace_back(std::move(ip));
     }
     // Announce the change to all clients.
     SendStatusMessage(IdMemberBanned, nickname);
@@ -456,11 +523,12 @@ void Room::RoomImpl::HandleModUnbanPacket(const ENetEvent* event) {
     packet >> address;
     bool unbanned{};
     {
-        std::lock_guard lock{ban_list_mutex};
-        auto it = std::find(ban_list.begin(), ban_list.end(), address);
-        if (it != ban_list.end()) {
+        std::lock_guard lock{ban_list->mutex};
+        auto& addresses{ban_list->addresses};
+        auto it = std::find(addresses.begin(), addresses.end(), address);
+        if (it != addresses.end()) {
             unbanned = true;
-            ban_list.erase(it);
+            addresses.erase(it);
         }
     }
     if (unbanned)
@@ -490,9 +558,7 @@ bool Room::RoomImpl::IsValidNickname(const std::string& nickname) const {
 
 bool Room::RoomImpl::IsValidMacAddress(const MacAddress& address) const {
     // A MAC address is valid if it isn't already taken by anybody else in the room.
-    std::lock_guard lock{member_mutex};
-    return std::all_of(members.begin(), members.end(),
-                       [&address](const auto& member) { return member.mac_address != address; });
+    return peers_by_mac.count(address) == 0;
 }
 
 bool Room::RoomImpl::IsValidConsoleId(u64 console_id) const {
@@ -620,8 +686,8 @@ void Room::RoomImpl::SendModBanListResponse(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdModBanListResponse);
     {
-        std::lock_guard lock{ban_list_mutex};
-        packet << ban_list;
+        std::lock_guard lock{ban_list->mutex};
+        packet << ban_list->addresses;
     }
     auto enet_packet{
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE)};
@@ -696,47 +762,42 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
+    // Message type, WifiPacket type, WifiPacket channel and WifiPacket transmitter address
+    constexpr std::size_t destination_offset{3 + sizeof(MacAddress)};
+    ENetPacket* const packet{event->packet};
+    relay_stats.packets_received.fetch_add(1, std::memory_order_relaxed);
+    if (packet->dataLength < destination_offset + sizeof(MacAddress)) {
+        LOG_ERROR(Network, "Received a truncated Wi-Fi packet of {} bytes", packet->dataLength);
+        relay_stats.packets_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
     MacAddress destination_address;
-    in_packet >> destination_address;
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    auto enet_packet{enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                        ENET_PACKET_FLAG_RELIABLE)};
+    std::memcpy(destination_address.data(), packet->data + destination_offset,
+                sizeof(MacAddress));
+    // Forward the packet on the channel it was received on, with the same reliability
+    const u8 channel{event->channelID == UnreliableChannel ? UnreliableChannel : ReliableChannel};
+    packet->flags = channel == ReliableChannel ? ENET_PACKET_FLAG_RELIABLE : 0;
+    u64 sent{};
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
-        std::lock_guard lock{member_mutex};
-        bool sent_packet{};
-        for (const auto& member : members) {
-            if (member.peer != event->peer) {
-                sent_packet = true;
-                enet_peer_send(member.peer, 0, enet_packet);
-            }
-        }
-        if (!sent_packet)
-            enet_packet_destroy(enet_packet);
+        for (const auto& [address, peer] : peers_by_mac)
+            if (peer != event->peer && enet_peer_send(peer, channel, packet) == 0)
+                ++sent;
     } else { // Send the data only to the destination client
-        std::lock_guard lock{member_mutex};
-        auto member{std::find_if(members.begin(), members.end(),
-                                 [destination_address](const Member& member) -> bool {
-                                     return member.mac_address == destination_address;
-                                 })};
-        if (member != members.end())
-            enet_peer_send(member->peer, 0, enet_packet);
-        else {
+        const auto itr{peers_by_mac.find(destination_address)};
+        if (itr == peers_by_mac.end()) {
             LOG_ERROR(Network,
                       "Attempting to send to unknown MAC address: "
                       "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
                       destination_address[0], destination_address[1], destination_address[2],
                       destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
+            relay_stats.packets_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
         }
+        if (enet_peer_send(itr->second, channel, packet) == 0)
+            ++sent;
     }
-    enet_host_flush(server);
+    relay_stats.packets_sent.fetch_add(sent, std::memory_order_relaxed);
+    relay_stats.bytes_sent.fetch_add(sent * packet->dataLength, std::memory_order_relaxed);
 }
 
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
@@ -797,7 +858,7 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
                                  [client](const Member& member) { return member.peer == client; })};
         if (member != members.end()) {
             nickname = member->nickname;
-            members.erase(member);
+            EraseMember(member);
         }
     }
     // Announce the change to all clients.
@@ -856,7 +917,7 @@ Room::~Room() = default;
 
 bool Room::Create(bool is_public, const std::string& name, const std::string& description,
                   const std::string& creator, u16 port, const std::string& password,
-                  const u32 max_connections, const Room::BanList& ban_list) {
+                  const u32 max_connections, const Room::BanList& ban_list, bool start_thread) {
     ENetAddress address;
     address.host = ENET_HOST_ANY;
     address.port = port;
@@ -865,6 +926,16 @@ bool Room::Create(bool is_public, const std::string& name, const std::string& de
     room_impl->server = enet_host_create(&address, max_connections + 1, NumChannels, 0, 0);
     if (!room_impl->server)
         return false;
+#ifndef _WIN32
+    // Polled rooms are waited on with select, which only takes descriptors below FD_SETSIZE
+    if (!start_thread && room_impl->server->socket >= FD_SETSIZE) {
+        LOG_ERROR(Network, "Socket {} of the room on port {} can't be polled",
+                  room_impl->server->socket, port);
+        enet_host_destroy(room_impl->server);
+        room_impl->server = nullptr;
+        return false;
+    }
+#endif
     room_impl->is_open.store(true, std::memory_order_relaxed);
     room_impl->room_information.name = name;
     room_impl->room_information.creator = creator;
@@ -872,9 +943,19 @@ bool Room::Create(bool is_public, const std::string& name, const std::string& de
     room_impl->room_information.max_members = max_connections;
     room_impl->room_information.port = port;
     room_impl->password = password;
-    room_impl->ban_list = ban_list;
+    if (!room_impl->shares_ban_list) {
+        std::lock_guard lock{room_impl->ban_list->mutex};
+        room_impl->ban_list->addresses = ban_list;
+    }
+    room_impl->relay_stats.packets_received = 0;
+    room_impl->relay_stats.packets_sent = 0;
+    room_impl->relay_stats.bytes_sent = 0;
+    room_impl->relay_stats.packets_dropped = 0;
+    room_impl->relay_stats.events_handled = 0;
+    room_impl->relay_stats.busy_time_us = 0;
     room_impl->is_public.store(is_public, std::memory_order_relaxed);
-    room_impl->StartLoop();
+    if (start_thread)
+        room_impl->StartLoop();
     if (room_impl->is_public.load(std::memory_order_relaxed)) {
         room_impl->http_server = std::make_shared<Server>(port);
         room_impl->http_server->start(true);
@@ -892,8 +973,8 @@ const RoomInformation& Room::GetRoomInformation() const {
 }
 
 Room::BanList Room::GetBanList() const {
-    std::lock_guard lock{room_impl->ban_list_mutex};
-    return room_impl->ban_list;
+    std::lock_guard lock{room_impl->ban_list->mutex};
+    return room_impl->ban_list->addresses;
 }
 
 std::vector<Room::Member> Room::GetRoomMemberList() const {
@@ -915,8 +996,11 @@ bool Room::HasPassword() const {
 
 void Room::Destroy() {
     room_impl->is_open.store(false, std::memory_order_relaxed);
-    room_impl->room_thread->join();
-    room_impl->room_thread.reset();
+    if (room_impl->room_thread) {
+        room_impl->room_thread->join();
+        room_impl->room_thread.reset();
+    } else
+        room_impl->SendCloseMessage();
     if (room_impl->server)
         enet_host_destroy(room_impl->server);
     if (room_impl->is_public.load(std::memory_order_relaxed))
@@ -927,10 +1011,13 @@ void Room::Destroy() {
     {
         std::lock_guard lock{room_impl->member_mutex};
         room_impl->members.clear();
+        room_impl->peers_by_mac.clear();
+    }
+    if (room_impl->http_server) {
+        room_impl->http_server->stop();
+        room_impl->http_server->waitForStop();
+        room_impl->http_server.reset();
     }
-    room_impl->http_server->stop();
-    room_impl->http_server->waitForStop();
-    room_impl->http_server.reset();
 }
 
 std::vector<JsonRoom> Room::GetRoomList() {
@@ -945,4 +1032,44 @@ bool Room::IsPublic() const {
     return room_impl->is_public.load(std::memory_order_relaxed);
 }
 
+Room::RelayStats Room::GetRelayStats() const {
+    const auto& counters{room_impl->relay_stats};
+    RelayStats stats;
+    stats.packets_received = counters.packets_received.load(std::memory_order_relaxed);
+    stats.packets_sent = counters.packets_sent.load(std::memory_order_relaxed);
+    stats.bytes_sent = counters.bytes_sent.load(std::memory_order_relaxed);
+    stats.packets_dropped = counters.packets_dropped.load(std::memory_order_relaxed);
+    stats.events_handled = counters.events_handled.load(std::memory_order_relaxed);
+    stats.busy_time_us = counters.busy_time_us.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Room::ShareBanList(std::shared_ptr<SharedBanList> ban_list) {
+    room_impl->ban_list = std::move(ban_list);
+    room_impl->shares_ban_list = true;
+}
+
+void Room::Poll(const std::vector<Room*>& rooms, u32 timeout_ms) {
+    if (rooms.empty())
+        return;
+    ASSERT_MSG(rooms.size() <= GetMaxPolledRooms(), "Too many rooms to poll");
+    ENetSocketSet read_set;
+    ENET_SOCKETSET_EMPTY(read_set);
+    ENetSocket max_socket{rooms.front()->room_impl->server->socket};
+    for (const Room* room : rooms) {
+        const ENetSocket socket{room->room_impl->server->socket};
+        ENET_SOCKETSET_ADD(read_set, socket);
+        max_socket = std::max(max_socket, socket);
+    }
+    // Timeouts and retransmissions are handled below, so it doesn't matter why this returns
+    enet_socketset_select(max_socket, &read_set, nullptr, timeout_ms);
+    for (Room* room : rooms)
+        if (room->IsOpen())
+            room->room_impl->HandleEvents(0);
+}
+
+std::size_t Room::GetMaxPolledRooms() {
+    return FD_SETSIZE;
+}
+
 } // namespace Network
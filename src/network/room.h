@@ -7,6 +7,7 @@
 #include <array>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -15,12 +16,17 @@
 
 namespace Network {
 
-constexpr u32 NetworkVersion{0xFF04}; ///< The network version
+constexpr u32 NetworkVersion{0xFF05}; ///< The network version
 constexpr u16 DefaultRoomPort{24872};
 constexpr u32 MaxMessageSize{500};
 constexpr u32 MaxConcurrentConnections{
     254}; ///< Maximum number of concurrent connections allowed to rooms.
-constexpr std::size_t NumChannels{1}; // Number of channels used for the connection
+constexpr std::size_t NumChannels{2}; // Number of channels used for the connection
+/// Channel of the reliable packets, which is used for everything except Wi-Fi data frames
+constexpr u8 ReliableChannel{0};
+/// Channel of the Wi-Fi data frames that may be dropped, so that a lost frame doesn't hold back
+/// the following ones
+constexpr u8 UnreliableChannel{1};
 
 struct RoomInformation {
     std::string name;        ///< Name of the room
@@ -104,6 +110,22 @@ public:
 
     using BanList = std::vector<std::string>;
 
+    /// Ban list that can be shared by several rooms
+    struct SharedBanList {
+        BanList addresses;
+        std::mutex mutex;
+    };
+
+    /// Traffic and load counters of the room since it was created
+    struct RelayStats {
+        u64 packets_received{}; ///< Wi-Fi packets received from members
+        u64 packets_sent{};     ///< Copies sent to members, a broadcast counts once per receiver
+        u64 bytes_sent{};
+        u64 packets_dropped{}; ///< Packets that were malformed or addressed to an unknown MAC
+        u64 events_handled{};  ///< ENet events of any kind
+        u64 busy_time_us{};    ///< Time spent handling events, excluding waiting for them
+    };
+
     Room();
     ~Room();
 
@@ -119,11 +141,30 @@ public:
     /// Checks if the room is password protected
     bool HasPassword() const;
 
-    /// Creates the socket for this room
+    /**
+     * Creates the socket for this room
+     * @param ban_list Initial ban list, ignored if the room uses a shared ban list
+     * @param start_thread Whether the room handles its traffic on its own thread. If not, Poll has
+     * to be called regularly.
+     */
     bool Create(bool is_public, const std::string& name, const std::string& description,
                 const std::string& creator, u16 port = DefaultRoomPort,
                 const std::string& password = "",
-                const u32 max_connections = MaxConcurrentConnections, const BanList& ban_list = {});
+                const u32 max_connections = MaxConcurrentConnections, const BanList& ban_list = {},
+                bool start_thread = true);
+
+    /// Makes the room use a ban list shared with other rooms. Must be called before Create.
+    void ShareBanList(std::shared_ptr<SharedBanList> ban_list);
+
+    /**
+     * Waits up to timeout_ms for any of the rooms to receive data and then handles the pending
+     * events of all of them. The rooms must have been created without their own thread, and must
+     * not be polled by several threads at once.
+     */
+    static void Poll(const std::vector<Room*>& rooms, u32 timeout_ms);
+
+    /// Maximum number of rooms that can be passed to Poll at once
+    static std::size_t GetMaxPolledRooms();
 
     /// Gets the banned IPs of the room.
     BanList GetBanList() const;
@@ -139,6 +180,8 @@ public:
 
     bool IsPublic() const;
 
+    RelayStats GetRelayStats() const;
+
 private:
     struct RoomImpl;
     std::unique_ptr<RoomImpl> room_impl;
@@ -41,8 +41,14 @@ struct RoomMember::RoomMemberImpl {
     std::mutex network_mutex; ///< Mutex that controls access to the client variable.
     std::unique_ptr<std::thread>
         loop_thread;             ///< Thread that receives and dispatches network packets
-    std::mutex send_list_mutex;  ///< Mutex that controls access to the send_list variable.
-    std::list<Packet> send_list; ///< A list that stores all packets to send the async
+    struct OutgoingPacket {
+        Packet packet;
+        bool reliable;
+    };
+
+    /// Mutex that controls access to the send_list variable.
+    std::mutex send_list_mutex;
+    std::list<OutgoingPacket> send_list; ///< A list that stores all packets to send the async
 
     template <typename T>
     using CallbackSet = std::set<CallbackHandle<T>>;
@@ -70,10 +76,11 @@ struct RoomMember::RoomMemberImpl {
     void StartLoop();
 
     /**
-     * Sends data to the room. It will be send on channel 0 with flag RELIABLE
+     * Sends data to the room. Reliable data is sent on ReliableChannel with flag RELIABLE, the
+     * rest on UnreliableChannel without flags.
      * @param packet The data to send
      */
-    void Send(Packet&& packet);
+    void Send(Packet&& packet, bool reliable = true);
 
     /**
      * Sends a request to the server, asking for permission to join a room with the specified
@@ -237,10 +244,11 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
         }
         {
             std::lock_guard lock{send_list_mutex};
-            for (const auto& packet : send_list) {
+            for (const auto& [packet, reliable] : send_list) {
                 auto enet_packet{enet_packet_create(packet.GetData(), packet.GetDataSize(),
-                                                    ENET_PACKET_FLAG_RELIABLE)};
-                enet_peer_send(server, 0, enet_packet);
+                                                    reliable ? ENET_PACKET_FLAG_RELIABLE : 0)};
+                enet_peer_send(server, reliable ? ReliableChannel : UnreliableChannel,
+                               enet_packet);
             }
             enet_host_flush(client);
             send_list.clear();
@@ -253,9 +261,9 @@ void RoomMember::RoomMemberImpl::StartLoop() {
     loop_thread = std::make_unique<std::thread>(&RoomMember::RoomMemberImpl::MemberLoop, this);
 }
 
-void RoomMember::RoomMemberImpl::Send(Packet&& packet) {
+void RoomMember::RoomMemberImpl::Send(Packet&& packet, bool reliable) {
     std::lock_guard lock{send_list_mutex};
-    send_list.push_back(std::move(packet));
+    send_list.push_back({std::move(packet), reliable});
 }
 
 void RoomMember::RoomMemberImpl::SendJoinRequest(const std::string& nickname, u64 console_id,
@@ -316,6 +324,7 @@ void RoomMember::RoomMemberImpl::HandleWifiPacket(const ENetEvent* event) {
     packet >> wifi_packet.transmitter_address;
     packet >> wifi_packet.destination_address;
     packet >> wifi_packet.data;
+    wifi_packet.reliable = event->channelID != UnreliableChannel;
     Invoke<WifiPacket>(wifi_packet);
 }
 
@@ -519,7 +528,7 @@ void RoomMember::SendWifiPacket(const WifiPacket& wifi_packet) {
     packet << wifi_packet.transmitter_address;
     packet << wifi_packet.destination_address;
     packet << wifi_packet.data;
-    room_member_impl->Send(std::move(packet));
+    room_member_impl->Send(std::move(packet), wifi_packet.reliable);
 }
 
 void RoomMember::SendChatMessage(const std::string& message) {
@@ -30,6 +30,9 @@ struct WifiPacket {
     MacAddress transmitter_address; ///< MAC address of the transmitter.
     MacAddress destination_address; ///< MAC address of the receiver.
     u8 channel;                     ///< Wifi channel where this frame was transmitted.
+    /// Whether the frame is retransmitted until it arrives. Frames that aren't may get lost, like
+    /// on real Wi-Fi, but don't delay the frames sent after them.
+    bool reliable{true};
 };
 
 /// Represents a chat message.
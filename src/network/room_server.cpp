@@ -0,0 +1,161 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <utility>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "network/room_server.h"
+
+namespace Network {
+
+/// Thread that handles the traffic of a subset of the rooms
+class RoomServer::Worker {
+public:
+    ~Worker() {
+        running.store(false, std::memory_order_relaxed);
+        thread.join();
+    }
+
+    void Add(Room* room) {
+        std::lock_guard lock{mutex};
+        added.push_back(room);
+    }
+
+    /// Blocks until the worker doesn't poll the room anymore
+    void Remove(Room* room) {
+        std::future<void> removed;
+        {
+            std::lock_guard lock{mutex};
+            removing.emplace_back(room, std::promise<void>{});
+            removed = removing.back().second.get_future();
+        }
+        removed.wait();
+    }
+
+    /// Number of rooms assigned to the worker, guarded by RoomServer::rooms_mutex
+    std::size_t num_rooms{};
+
+private:
+    void Loop() {
+        while (running.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard lock{mutex};
+                active.insert(active.end(), added.begin(), added.end());
+                added.clear();
+                for (auto& [room, removed] : removing) {
+                    active.erase(std::remove(active.begin(), active.end(), room), active.end());
+                    removed.set_value();
+                }
+                removing.clear();
+            }
+            if (active.empty())
+                std::this_thread::sleep_for(std::chrono::milliseconds{50});
+            else
+                Room::Poll(active, 50);
+        }
+    }
+
+    std::atomic_bool running{true};
+
+    std::mutex mutex; ///< Mutex for locking the rooms that are being added or removed
+    std::vector<Room*> added;
+    std::vector<std::pair<Room*, std::promise<void>>> removing;
+
+    std::vector<Room*> active; ///< Rooms being polled, only used by the worker thread
+
+    std::thread thread{&Worker::Loop, this};
+};
+
+RoomServer::RoomServer(std::size_t num_workers) {
+    ASSERT(num_workers > 0);
+    for (std::size_t i{}; i < num_workers; ++i)
+        workers.push_back(std::make_unique<Worker>());
+}
+
+RoomServer::~RoomServer() {
+    for (Room* room : GetRooms())
+        CloseRoom(room);
+}
+
+Room* RoomServer::CreateRoom(bool is_public, const std::string& name,
+                             const std::string& description, const std::string& creator,
+                             u16 port, const std::string& password, u32 max_connections) {
+    Worker* worker;
+    {
+        std::lock_guard lock{rooms_mutex};
+        worker = std::min_element(workers.begin(), workers.end(),
+                                  [](const auto& a, const auto& b) {
+                                      return a->num_rooms < b->num_rooms;
+                                  })
+                     ->get();
+        if (worker->num_rooms >= Room::GetMaxPolledRooms()) {
+            LOG_ERROR(Network, "Can't host more than {} rooms per thread",
+                      Room::GetMaxPolledRooms());
+            return nullptr;
+        }
+        // Reserve the slot, so that concurrent calls can't overfill the worker
+        ++worker->num_rooms;
+    }
+    auto room{std::make_unique<Room>()};
+    room->ShareBanList(ban_list);
+    if (error_callback)
+        room->SetErrorCallback(error_callback);
+    // The lock isn't held while creating the room, since announcing it makes a web request
+    const bool created{room->Create(is_public, name, description, creator, port, password,
+                                    max_connections, {}, false)};
+    std::lock_guard lock{rooms_mutex};
+    if (!created) {
+        --worker->num_rooms;
+        return nullptr;
+    }
+    worker->Add(room.get());
+    rooms.push_back({std::move(room), worker});
+    return rooms.back().room.get();
+}
+
+void RoomServer::CloseRoom(Room* room) {
+    HostedRoom hosted;
+    {
+        std::lock_guard lock{rooms_mutex};
+        auto itr{std::find_if(rooms.begin(), rooms.end(), [room](const HostedRoom& entry) {
+            return entry.room.get() == room;
+        })};
+        if (itr == rooms.end())
+            return;
+        hosted = std::move(*itr);
+        rooms.erase(itr);
+        --hosted.worker->num_rooms;
+    }
+    hosted.worker->Remove(room);
+    room->Destroy();
+}
+
+std::vector<Room*> RoomServer::GetRooms() const {
+    std::lock_guard lock{rooms_mutex};
+    std::vector<Room*> result;
+    for (const auto& hosted : rooms)
+        result.push_back(hosted.room.get());
+    return result;
+}
+
+Room::BanList RoomServer::GetBanList() const {
+    std::lock_guard lock{ban_list->mutex};
+    return ban_list->addresses;
+}
+
+void RoomServer::SetBanList(Room::BanList addresses) {
+    std::lock_guard lock{ban_list->mutex};
+    ban_list->addresses = std::move(addresses);
+}
+
+void RoomServer::SetErrorCallback(ErrorCallback cb) {
+    error_callback = std::move(cb);
+}
+
+} // namespace Network
@@ -0,0 +1,65 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "network/room.h"
+
+namespace Network {
+
+/**
+ * Hosts several rooms in one process. Each room has its own ENet host, and the rooms are spread
+ * over a fixed number of worker threads that each wait on the sockets of all of their rooms at
+ * once. The rooms share one ban list.
+ */
+class RoomServer final {
+public:
+    explicit RoomServer(std::size_t num_workers);
+
+    /// Closes all rooms
+    ~RoomServer();
+
+    /**
+     * Creates a room and hands it to the worker with the fewest rooms.
+     * @return The room, or nullptr if its socket couldn't be created or every worker already polls
+     * Room::GetMaxPolledRooms rooms
+     */
+    Room* CreateRoom(bool is_public, const std::string& name, const std::string& description,
+                     const std::string& creator, u16 port, const std::string& password,
+                     u32 max_connections);
+
+    /// Notifies the members of the room that it's closed and destroys it, other rooms keep running
+    void CloseRoom(Room* room);
+
+    std::vector<Room*> GetRooms() const;
+
+    Room::BanList GetBanList() const;
+    void SetBanList(Room::BanList ban_list);
+
+    /// Sets a function to call when a error happens in 'MakeRequest' for rooms created afterwards
+    void SetErrorCallback(ErrorCallback cb);
+
+private:
+    class Worker;
+
+    struct HostedRoom {
+        std::unique_ptr<Room> room;
+        Worker* worker;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::vector<HostedRoom> rooms;
+    mutable std::mutex rooms_mutex;
+
+    std::shared_ptr<Room::SharedBanList> ban_list{std::make_shared<Room::SharedBanList>()};
+    ErrorCallback error_callback;
+};
+
+} // namespace Network
@@ -1320,6 +1320,7 @@ void RasterizerCache::ValidateSurface(const Surface& surface, PAddr addr, u32 si
         surface->UploadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
                                  draw_framebuffer.handle);
         surface->invalid_regions.erase(params.GetInterval());
+        memory.RasterizerMarkRegionLoaded(params.addr, params.size);
     }
 }
 
@@ -1391,9 +1392,10 @@ void RasterizerCache::InvalidateRegion(PAddr addr, u32 size, const Surface& regi
                 remove_surfaces.emplace(cached_surface);
         }
     }
-    if (region_owner)
+    if (region_owner) {
         dirty_regions.set({invalid_interval, region_owner});
-    else
+        memory.RasterizerMarkRegionDirty(addr, size);
+    } else
         dirty_regions.erase(invalid_interval);
     for (auto& remove_surface : remove_surfaces) {
         if (remove_surface == region_owner) {